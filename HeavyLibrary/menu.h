@@ -7,17 +7,44 @@
 #include <vector>
 #include <algorithm>
 #include <cstdlib>
-#include <locale>
-#include <codecvt>
 #include <functional>
+#include <memory>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #ifdef _WIN32
     #include <windows.h>
     #include <conio.h>
+    #include <io.h>
 #else
     #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
     #include <unistd.h>
-    #include <conio.h> /* if you use a platform-specific getch implementation, keep it */
+    #include <cerrno>
+    #include <termios.h>
+    #include <poll.h>
+    #include <csignal>
+    #ifdef __linux__
+        #include <sys/timerfd.h>
+    #endif
+#endif
+
+/* SIMD kernels for the batch HSLtoRGB, chosen by the compiler's target flags */
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define MENU_HSL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define MENU_HSL_SSE2
 #endif
 
 /* Console cursor macro (kept for compatibility) */
@@ -44,8 +71,14 @@
 #define RESET_ALL "\033[0m"
 
 #define ERASE_CONSOLE "\033c"
+#define ERASE_SCREEN "\033[2J"
+
+/* DEC private mode 2026: the terminal holds presentation until the end sequence */
+#define BEGIN_SYNCHRONIZED_UPDATE "\033[?2026h"
+#define END_SYNCHRONIZED_UPDATE "\033[?2026l"
 
 /* Key codes in use (kept for compatibility) */
+/* DOS scan codes for the arrows, as a second _getch() returns them; see InputKeys */
 #define KEY_UP 72
 #define KEY_DOWN 80
 
@@ -61,6 +94,96 @@ struct color {
     unsigned char b = 0;
 };
 
+/* --------------------------------------------------------------------------
+   escape - allocation-free escape sequence encoder
+   -------------------------------------------------------------------------- */
+/*
+ * All writers take a caller-supplied output pointer, write at it and return
+ * the position after the last byte written. Nothing allocates; decimal
+ * arguments 0..255 come from a table built at compile time.
+ */
+namespace escape {
+    struct decimalTable {
+        char digits[256][3];
+        unsigned char length[256];
+    };
+
+    constexpr decimalTable makeDecimalTable() {
+        decimalTable table{};
+        for (int v = 0; v < 256; ++v) {
+            int n = 0;
+            if (v >= 100) table.digits[v][n++] = static_cast<char>('0' + v / 100);
+            if (v >= 10)  table.digits[v][n++] = static_cast<char>('0' + (v / 10) % 10);
+            table.digits[v][n++] = static_cast<char>('0' + v % 10);
+            table.length[v] = static_cast<unsigned char>(n);
+        }
+        return table;
+    }
+
+    constexpr decimalTable decimals = makeDecimalTable();
+
+    /* Longest SGR sequence sgrState can produce: ESC[0;1;5;38;2;255;255;255;48;2;255;255;255m */
+    constexpr size_t MAX_SGR_LENGTH = 48;
+    /* Longest cursor move: ESC[<10 digits>;<10 digits>H */
+    constexpr size_t MAX_CURSOR_LENGTH = 32;
+
+    inline char* put(char* out, const char* text) {
+        while (*text) *out++ = *text++;
+        return out;
+    }
+
+    inline char* putByte(char* out, unsigned char v) {
+        const char* digits = decimals.digits[v];
+        for (unsigned char i = 0; i < decimals.length[v]; ++i) *out++ = digits[i];
+        return out;
+    }
+
+    inline char* putInt(char* out, int v) {
+        if (v >= 0 && v < 256) return putByte(out, static_cast<unsigned char>(v));
+
+        char reversed[12];
+        int n = 0;
+        unsigned int u = v < 0 ? 0u - static_cast<unsigned int>(v) : static_cast<unsigned int>(v);
+        if (v < 0) *out++ = '-';
+        do { reversed[n++] = static_cast<char>('0' + u % 10); u /= 10; } while (u);
+        while (n) *out++ = reversed[--n];
+        return out;
+    }
+
+    /* "<introducer>r;g;b", e.g. introducer = FOREGROUND_SEQUENCE */
+    inline char* putRGB(char* out, const char* introducer, const color& c) {
+        out = put(out, introducer);
+        out = putByte(out, c.r);
+        *out++ = ';';
+        out = putByte(out, c.g);
+        *out++ = ';';
+        return putByte(out, c.b);
+    }
+
+    /* Complete foreground / background color sequences */
+    inline char* foreground(char* out, const color& c) {
+        out = put(out, ESC_COLOR_CODE);
+        out = putRGB(out, FOREGROUND_SEQUENCE, c);
+        return put(out, CLOSE_SEQUENCE);
+    }
+
+    inline char* background(char* out, const color& c) {
+        out = put(out, ESC_COLOR_CODE);
+        out = putRGB(out, BACKGROUND_SEQUENCE, c);
+        return put(out, CLOSE_SEQUENCE);
+    }
+
+    /* Absolute cursor move, 0-based x/y */
+    inline char* cursorTo(char* out, int x, int y) {
+        out = put(out, START_SEQUENCE);
+        out = putInt(out, y + 1);
+        *out++ = ';';
+        out = putInt(out, x + 1);
+        *out++ = 'H';
+        return out;
+    }
+}
+
 /* --------------------------------------------------------------------------
    HSL to RGB conversion
    - kept as a free function to minimize API changes
@@ -98,6 +221,142 @@ inline color HSLtoRGB(double h, double s, double l) {
     return result;
 }
 
+/*
+ * HSLtoRGB(h, s, l, out, count)
+ *
+ * Batch form for gradients: converts count HSL triples held in separate
+ * arrays (hue in degrees, any value). It works in float with the
+ * branch-free 12-sector formula, 8 lanes at a time with AVX or 4 with
+ * SSE2 when the compiler targets them, and a scalar loop for the rest.
+ * Results can differ from the double version above by one step.
+ */
+namespace hslKernel {
+    /* Channel n (0 red, 8 green, 4 blue): l - a * clamp(min(k - 3, 9 - k), -1, 1) */
+    inline float channel(float n, float h30, float a, float l) {
+        float k = n + h30;
+        if (k >= 12.0f) k -= 12.0f;
+        return l - a * std::max(-1.0f, std::min(std::min(k - 3.0f, 9.0f - k), 1.0f));
+    }
+
+    inline unsigned char toByte(float v) {
+        return static_cast<unsigned char>(std::min(std::max(v * 255.0f + 0.5f, 0.0f), 255.5f));
+    }
+
+    inline void convertOne(float h, float s, float l, unsigned char rgb[3]) {
+        h -= 360.0f * std::floor(h / 360.0f);
+        const float h30 = h / 30.0f;
+        const float a = s * std::min(l, 1.0f - l);
+        rgb[0] = toByte(channel(0.0f, h30, a, l));
+        rgb[1] = toByte(channel(8.0f, h30, a, l));
+        rgb[2] = toByte(channel(4.0f, h30, a, l));
+    }
+
+#if defined(MENU_HSL_AVX)
+    static const int LANES = 8;
+
+    inline __m256 channel(__m256 n, __m256 h30, __m256 a, __m256 l) {
+        const __m256 twelve = _mm256_set1_ps(12.0f);
+        __m256 k = _mm256_add_ps(n, h30);
+        k = _mm256_sub_ps(k, _mm256_and_ps(_mm256_cmp_ps(k, twelve, _CMP_GE_OQ), twelve));
+        __m256 t = _mm256_min_ps(_mm256_sub_ps(k, _mm256_set1_ps(3.0f)), _mm256_sub_ps(_mm256_set1_ps(9.0f), k));
+        t = _mm256_max_ps(_mm256_set1_ps(-1.0f), _mm256_min_ps(t, _mm256_set1_ps(1.0f)));
+        return _mm256_sub_ps(l, _mm256_mul_ps(a, t));
+    }
+
+    inline void toBytes(__m256 v, int out[LANES]) {
+        v = _mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f));
+        v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(255.5f));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvttps_epi32(v));
+    }
+
+    /* Converts LANES triples; s and l are broadcast when their step is 0 */
+    inline void convertLanes(const float* h, const float* s, size_t s_step,
+                             const float* l, size_t l_step, int r[LANES], int g[LANES], int b[LANES]) {
+        __m256 hv = _mm256_loadu_ps(h);
+        const __m256 sv = s_step ? _mm256_loadu_ps(s) : _mm256_set1_ps(*s);
+        const __m256 lv = l_step ? _mm256_loadu_ps(l) : _mm256_set1_ps(*l);
+
+        const __m256 full = _mm256_set1_ps(360.0f);
+        hv = _mm256_sub_ps(hv, _mm256_mul_ps(full, _mm256_floor_ps(_mm256_div_ps(hv, full))));
+        const __m256 h30 = _mm256_div_ps(hv, _mm256_set1_ps(30.0f));
+        const __m256 a = _mm256_mul_ps(sv, _mm256_min_ps(lv, _mm256_sub_ps(_mm256_set1_ps(1.0f), lv)));
+
+        toBytes(channel(_mm256_setzero_ps(), h30, a, lv), r);
+        toBytes(channel(_mm256_set1_ps(8.0f), h30, a, lv), g);
+        toBytes(channel(_mm256_set1_ps(4.0f), h30, a, lv), b);
+    }
+#elif defined(MENU_HSL_SSE2)
+    static const int LANES = 4;
+
+    /* SSE2 has no floor: truncate, then step down where that rounded up */
+    inline __m128 floor(__m128 x) {
+        const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+    }
+
+    inline __m128 channel(__m128 n, __m128 h30, __m128 a, __m128 l) {
+        const __m128 twelve = _mm_set1_ps(12.0f);
+        __m128 k = _mm_add_ps(n, h30);
+        k = _mm_sub_ps(k, _mm_and_ps(_mm_cmpge_ps(k, twelve), twelve));
+        __m128 t = _mm_min_ps(_mm_sub_ps(k, _mm_set1_ps(3.0f)), _mm_sub_ps(_mm_set1_ps(9.0f), k));
+        t = _mm_max_ps(_mm_set1_ps(-1.0f), _mm_min_ps(t, _mm_set1_ps(1.0f)));
+        return _mm_sub_ps(l, _mm_mul_ps(a, t));
+    }
+
+    inline void toBytes(__m128 v, int out[LANES]) {
+        v = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.5f));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_cvttps_epi32(v));
+    }
+
+    /* Converts LANES triples; s and l are broadcast when their step is 0 */
+    inline void convertLanes(const float* h, const float* s, size_t s_step,
+                             const float* l, size_t l_step, int r[LANES], int g[LANES], int b[LANES]) {
+        __m128 hv = _mm_loadu_ps(h);
+        const __m128 sv = s_step ? _mm_loadu_ps(s) : _mm_set1_ps(*s);
+        const __m128 lv = l_step ? _mm_loadu_ps(l) : _mm_set1_ps(*l);
+
+        const __m128 full = _mm_set1_ps(360.0f);
+        hv = _mm_sub_ps(hv, _mm_mul_ps(full, floor(_mm_div_ps(hv, full))));
+        const __m128 h30 = _mm_div_ps(hv, _mm_set1_ps(30.0f));
+        const __m128 a = _mm_mul_ps(sv, _mm_min_ps(lv, _mm_sub_ps(_mm_set1_ps(1.0f), lv)));
+
+        toBytes(channel(_mm_setzero_ps(), h30, a, lv), r);
+        toBytes(channel(_mm_set1_ps(8.0f), h30, a, lv), g);
+        toBytes(channel(_mm_set1_ps(4.0f), h30, a, lv), b);
+    }
+#endif
+
+    inline void convert(const float* h, const float* s, size_t s_step, const float* l, size_t l_step,
+                        color* out, size_t count) {
+        size_t i = 0;
+#if defined(MENU_HSL_AVX) || defined(MENU_HSL_SSE2)
+        int r[LANES], g[LANES], b[LANES];
+        for (; i + LANES <= count; i += LANES) {
+            convertLanes(h + i, s + i * s_step, s_step, l + i * l_step, l_step, r, g, b);
+            for (int k = 0; k < LANES; ++k)
+                out[i + k] = color{ static_cast<unsigned char>(r[k]),
+                                    static_cast<unsigned char>(g[k]),
+                                    static_cast<unsigned char>(b[k]) };
+        }
+#endif
+        unsigned char rgb[3];
+        for (; i < count; ++i) {
+            convertOne(h[i], s[i * s_step], l[i * l_step], rgb);
+            out[i] = color{ rgb[0], rgb[1], rgb[2] };
+        }
+    }
+}
+
+inline void HSLtoRGB(const float* h, const float* s, const float* l, color* out, size_t count) {
+    hslKernel::convert(h, s, 1, l, 1, out, count);
+}
+
+/* Same, with one saturation and lightness for every hue (the usual gradient) */
+inline void HSLtoRGB(const float* h, float s, float l, color* out, size_t count) {
+    hslKernel::convert(h, &s, 0, &l, 0, out, count);
+}
+
 /* --------------------------------------------------------------------------
    c_pixel - color/formatting for a character cell
    - previously everything was public; now fields are private with accessors
@@ -162,6 +421,14 @@ public:
     void setBlinking(bool on) noexcept { blinking_ = on; }
     void setBold(bool on) noexcept { bold_ = on; }
 
+    /* Comparison (used by the diff renderer) */
+    bool operator==(const c_pixel& other) const noexcept {
+        return foreground_.r == other.foreground_.r && foreground_.g == other.foreground_.g && foreground_.b == other.foreground_.b
+            && background_.r == other.background_.r && background_.g == other.background_.g && background_.b == other.background_.b
+            && blinking_ == other.blinking_ && bold_ == other.bold_;
+    }
+    bool operator!=(const c_pixel& other) const noexcept { return !(*this == other); }
+
     /*
      * setTextColor()
      *
@@ -194,40 +461,187 @@ private:
     bool bold_;
 };
 
+/* --------------------------------------------------------------------------
+   sgrState - tracks the terminal's current SGR (color/attribute) state
+   -------------------------------------------------------------------------- */
+/*
+ * sgrState
+ *
+ * Remembers the foreground, background, bold and blink state last sent to
+ * the terminal. apply() appends a single CSI sequence containing only the
+ * attributes that differ from that state (or nothing at all).
+ * Starts out "unknown", in which case the first apply() resets everything.
+ */
+class sgrState {
+public:
+    sgrState() : current_(), known_(false) {}
+
+    /* Forget the terminal state (e.g. after something else wrote to it) */
+    void invalidate() noexcept { known_ = false; }
+
+    void apply(std::string & out, const c_pixel & pix) {
+        char seq[escape::MAX_SGR_LENGTH];
+        out.append(seq, static_cast<size_t>(apply(seq, pix) - seq));
+    }
+
+    /* Writes the sequence (if any) at out; returns the end of what was written */
+    char* apply(char* out, const c_pixel & pix) {
+        if (known_ && pix == current_) return out;
+
+        char* const params = out + 2;
+        out = escape::put(out, ESC_COLOR_CODE);
+        if (!known_) {
+            *out++ = '0';
+            if (pix.bold())     out = escape::put(out, SEQUENCE_ARG_SEPARATOR "1");
+            if (pix.blinking()) out = escape::put(out, SEQUENCE_ARG_SEPARATOR "5");
+        } else {
+            if (pix.bold() != current_.bold())
+                out = escape::put(out, pix.bold() ? "1" : "22");
+            if (pix.blinking() != current_.blinking())
+                out = escape::put(separate(out, params), pix.blinking() ? "5" : "25");
+        }
+
+        if (!known_ || !sameColor(pix.foreground(), current_.foreground()))
+            out = escape::putRGB(separate(out, params), FOREGROUND_SEQUENCE, pix.foreground());
+        if (!known_ || !sameColor(pix.background(), current_.background()))
+            out = escape::putRGB(separate(out, params), BACKGROUND_SEQUENCE, pix.background());
+
+        current_ = pix;
+        known_ = true;
+        return escape::put(out, CLOSE_SEQUENCE);
+    }
+
+private:
+    static bool sameColor(const color & a, const color & b) noexcept {
+        return a.r == b.r && a.g == b.g && a.b == b.b;
+    }
+
+    /* Add a ';' unless this is the first parameter */
+    static char* separate(char* out, const char* params) noexcept {
+        if (out != params) *out++ = ';';
+        return out;
+    }
+
+    c_pixel current_;
+    bool known_;
+};
+
 /* --------------------------------------------------------------------------
    UTF-32 -> UTF-8 conversion utility
    - kept inline and static-like to remain header-only
    -------------------------------------------------------------------------- */
+/*
+ * encode_utf8(c, out) -> number of bytes written (1..4)
+ *
+ * Encodes one codepoint into out, which must have room for 4 bytes.
+ */
+static inline int encode_utf8(char32_t c, char * out) {
+    if (c <= 0x7F) {
+        out[0] = static_cast<char>(c);
+        return 1;
+    } else if (c <= 0x7FF) {
+        out[0] = static_cast<char>(0xC0 | (c >> 6));
+        out[1] = static_cast<char>(0x80 | (c & 0x3F));
+        return 2;
+    } else if (c <= 0xFFFF) {
+        out[0] = static_cast<char>(0xE0 | (c >> 12));
+        out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (c & 0x3F));
+        return 3;
+    } else {
+        out[0] = static_cast<char>(0xF0 | (c >> 18));
+        out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (c & 0x3F));
+        return 4;
+    }
+}
+
 /*
  * to_utf8(u32string) -> string
  *
  * Simple conversion from a std::u32string to a UTF-8 std::string.
- * This implementation is minimal and matches the behavior in the original file.
  */
 static inline std::string to_utf8(const std::u32string & src) {
     std::string result;
     result.reserve(src.size() * 4);
 
-    for (char32_t c : src) {
-        if (c <= 0x7F) {
-            result.push_back(static_cast<char>(c));
-        } else if (c <= 0x7FF) {
-            result.push_back(static_cast<char>(0xC0 | (c >> 6)));
-            result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
-        } else if (c <= 0xFFFF) {
-            result.push_back(static_cast<char>(0xE0 | (c >> 12)));
-            result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
-            result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
-        } else {
-            result.push_back(static_cast<char>(0xF0 | (c >> 18)));
-            result.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
-            result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
-            result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    char bytes[4];
+    for (char32_t c : src)
+        result.append(bytes, static_cast<size_t>(encode_utf8(c, bytes)));
+    return result;
+}
+
+/*
+ * from_utf8(string) -> u32string
+ *
+ * Inverse of to_utf8. Malformed sequences are replaced with U+FFFD.
+ */
+static inline std::u32string from_utf8(const std::string & src) {
+    std::u32string result;
+    result.reserve(src.size());
+
+    size_t i = 0;
+    while (i < src.size()) {
+        unsigned char lead = static_cast<unsigned char>(src[i]);
+        int extra = 0;
+        char32_t c = 0;
+
+        if (lead < 0x80)                { c = lead; }
+        else if ((lead & 0xE0) == 0xC0) { c = lead & 0x1F; extra = 1; }
+        else if ((lead & 0xF0) == 0xE0) { c = lead & 0x0F; extra = 2; }
+        else if ((lead & 0xF8) == 0xF0) { c = lead & 0x07; extra = 3; }
+        else                            { result.push_back(U'�'); ++i; continue; }
+
+        if (extra && i + extra >= src.size()) { result.push_back(U'�'); break; }
+
+        bool valid = true;
+        for (int k = 1; k <= extra; ++k) {
+            unsigned char cont = static_cast<unsigned char>(src[i + k]);
+            if ((cont & 0xC0) != 0x80) { valid = false; break; }
+            c = (c << 6) | (cont & 0x3F);
         }
+
+        if (!valid) { result.push_back(U'�'); ++i; continue; }
+        result.push_back(c);
+        i += 1 + extra;
     }
     return result;
 }
 
+/* --------------------------------------------------------------------------
+   encodedGlyph - a codepoint with its UTF-8 bytes
+   -------------------------------------------------------------------------- */
+/*
+ * encodedGlyph
+ *
+ * The text half of a terminal cell: the codepoint and its UTF-8 encoding,
+ * computed once in set(). Copying one is a fixed-size struct copy, which is
+ * what lets font atlases and cell grids move glyphs without re-encoding.
+ */
+class encodedGlyph {
+public:
+    encodedGlyph() noexcept : codepoint_(U' '), bytes_{' ', 0, 0, 0}, length_(1) {}
+    explicit encodedGlyph(char32_t c) noexcept : encodedGlyph() { set(c); }
+
+    void set(char32_t c) noexcept {
+        codepoint_ = c;
+        length_ = static_cast<unsigned char>(encode_utf8(c, bytes_));
+    }
+
+    char32_t codepoint() const noexcept { return codepoint_; }
+    const char* utf8() const noexcept { return bytes_; }
+    size_t utf8Length() const noexcept { return length_; }
+
+    bool operator==(const encodedGlyph& other) const noexcept { return codepoint_ == other.codepoint_; }
+    bool operator!=(const encodedGlyph& other) const noexcept { return codepoint_ != other.codepoint_; }
+
+private:
+    char32_t codepoint_;
+    char bytes_[4];
+    unsigned char length_;
+};
+
 /* --------------------------------------------------------------------------
    AvailableFonts - enum
    -------------------------------------------------------------------------- */
@@ -258,6 +672,183 @@ inline c_pixel rainbowUV(double x, double y) {
     return result;
 }
 
+/*
+ * goldRedUV(x, y) -> c_pixel
+ * Hues from red to gold across the box; the formula of the example's GOLDRED.
+ */
+inline c_pixel goldRedUV(double x, double y) {
+    return c_pixel(HSLtoRGB(x * y * 30.0, 1.0, 0.5));
+}
+
+/* --------------------------------------------------------------------------
+   gradientRamp - a one-coordinate gradient sampled into a lookup table
+   -------------------------------------------------------------------------- */
+/*
+ * gradientRamp
+ *
+ * Entry i of sample(size) is the function's color at x = i / size. The
+ * table is rebuilt only when a different size is asked for or the
+ * function is replaced, so a gradient across a fixed width is evaluated
+ * once instead of once per character per frame.
+ */
+class gradientRamp {
+public:
+    gradientRamp() : stale_(true) {}
+    explicit gradientRamp(std::function<color(double)> fn) : function_(std::move(fn)), stale_(true) {}
+
+    void setFunction(std::function<color(double)> fn) {
+        function_ = std::move(fn);
+        stale_ = true;
+    }
+
+    bool empty() const { return !function_; }
+
+    const std::vector<color>& sample(size_t size) {
+        if (stale_ || table_.size() != size) {
+            table_.assign(size, color());
+            if (function_) {
+                for (size_t i = 0; i < size; ++i)
+                    table_[i] = function_(static_cast<double>(i) / static_cast<double>(size));
+            }
+            stale_ = false;
+        }
+        return table_;
+    }
+
+private:
+    std::function<color(double)> function_;
+    std::vector<color> table_;
+    bool stale_;
+};
+
+/*
+ * separableGradient
+ *
+ * A foreground gradient whose channels factor into a column term and a row
+ * term. With x and y normalized to [0, 1), each channel is
+ *
+ *     (x0 + x1 * x) * (y0 + y1 * y) * gain + (o0 + o1 * y)
+ *
+ * truncated to 0..255. cliMenu::addGradient(separableGradient) evaluates
+ * the terms once per column and once per row, then combines them, and
+ * reuses the result while the size and coefficients stay the same.
+ */
+struct separableGradient {
+    struct channel {
+        double x0, x1;
+        double y0, y1;
+        double gain;
+        double o0, o1;
+
+        bool operator==(const channel & other) const {
+            return x0 == other.x0 && x1 == other.x1 && y0 == other.y0 && y1 == other.y1
+                && gain == other.gain && o0 == other.o0 && o1 == other.o1;
+        }
+        bool operator!=(const channel & other) const { return !(*this == other); }
+    };
+
+    channel r, g, b;
+
+    bool operator==(const separableGradient & other) const {
+        return r == other.r && g == other.g && b == other.b;
+    }
+    bool operator!=(const separableGradient & other) const { return !(*this == other); }
+
+    /* addGradient()'s look: red grows downwards, green to the right fading down, blue fixed */
+    static separableGradient classic() {
+        separableGradient result;
+        result.r = channel{ 0.0, 0.0, 0.0, 0.0, 255.0, 0.0, 255.0 };
+        result.g = channel{ 0.0, 1.0, 1.0, -1.0, 255.0, 0.0, 0.0 };
+        result.b = channel{ 0.0, 0.0, 0.0, 0.0, 255.0, 250.0, 0.0 };
+        return result;
+    }
+};
+
+/* --------------------------------------------------------------------------
+   colorSpanFunction - batch form of a color function
+   -------------------------------------------------------------------------- */
+/*
+ * colorSpanFunction(xs, count, y, out)
+ *
+ * Colors one row of cells in a single call: out[i] gets the color at
+ * normalized coordinates (xs[i], y). Callers compute xs once per box, and
+ * the body is a plain loop the compiler can inline and vectorize, instead
+ * of one indirect call per cell.
+ */
+typedef std::function<void(const double* xs, int count, double y, c_pixel* out)> colorSpanFunction;
+
+/* Wrap a per-cell color function as a colorSpanFunction */
+inline colorSpanFunction spanOf(std::function<c_pixel(double, double)> fn) {
+    if (!fn) return nullptr;
+    return [fn](const double* xs, int count, double y, c_pixel* out) {
+        for (int i = 0; i < count; ++i) out[i] = fn(xs[i], y);
+    };
+}
+
+/*
+ * Span forms of the built-in color functions. Hues go through the batch
+ * HSLtoRGB in chunks on the stack, so a row costs no allocation.
+ */
+inline void hueSpan(const double* xs, int count, double y, double degrees, float s, float l,
+                    bool bold, c_pixel* out) {
+    const int CHUNK = 64;
+    float hues[CHUNK];
+    color rgb[CHUNK];
+    for (int done = 0; done < count; done += CHUNK) {
+        const int n = std::min(CHUNK, count - done);
+        for (int i = 0; i < n; ++i) hues[i] = static_cast<float>(xs[done + i] * y * degrees);
+        HSLtoRGB(hues, s, l, rgb, static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i) {
+            out[done + i] = c_pixel(rgb[i]);
+            out[done + i].setBold(bold);
+        }
+    }
+}
+
+inline void rainbowUVSpan(const double* xs, int count, double y, c_pixel* out) {
+    hueSpan(xs, count, y, 360.0, 0.7f, 0.7f, true, out);
+}
+
+inline void goldRedUVSpan(const double* xs, int count, double y, c_pixel* out) {
+    hueSpan(xs, count, y, 30.0, 1.0f, 0.5f, false, out);
+}
+
+/* --------------------------------------------------------------------------
+   glyphRow / glyphRows - non-owning views over glyph text
+   -------------------------------------------------------------------------- */
+/*
+ * glyphRow - one row of a glyph: a pointer to UTF-32 text and its length.
+ * Implicitly constructible from a U"..." literal, so glyph tables can be constexpr.
+ */
+struct glyphRow {
+    template <size_t N>
+    constexpr glyphRow(const char32_t (&literal)[N]) : text(literal), len(static_cast<int>(N - 1)) {}
+    constexpr glyphRow(const char32_t* t, int l) : text(t), len(l) {}
+
+    constexpr int length() const { return len; }
+    constexpr int size() const { return len; }
+    constexpr char32_t operator[](int i) const { return text[i]; }
+
+    const char32_t* text;
+    int len;
+};
+
+/*
+ * glyphRows - a contiguous run of glyphRow (all the rows of one glyph).
+ */
+struct glyphRows {
+    constexpr glyphRows(const glyphRow* r, int c) : rows(r), count(c) {}
+
+    constexpr int size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+    constexpr const glyphRow& operator[](int i) const { return rows[i]; }
+    constexpr const glyphRow* begin() const { return rows; }
+    constexpr const glyphRow* end() const { return rows + count; }
+
+    const glyphRow* rows;
+    int count;
+};
+
 /* --------------------------------------------------------------------------
    Character - representation of a pseudo-font character (multi-line)
    -------------------------------------------------------------------------- */
@@ -267,143 +858,536 @@ inline c_pixel rainbowUV(double x, double y) {
  * Contains:
  *  - representation: the ASCII character that this glyph represents
  *  - width/height: logical dimensions (width could be inferred but kept)
- *  - data: vector of u32 strings (each row)
+ *  - data: view of the glyph rows (owned by a static table or by a Font)
+ *  - dataWidth/dataHeight: measured size of data (widest row, row count)
+ *
+ * A literal type, so glyph tables can be laid out at compile time.
  */
 class Character {
 public:
-    Character(char r, int w, int h, const std::vector<std::u32string>& d)
-        : representation(r), width(w), height(h), data(d) {}
+    constexpr Character(char r, int w, int h, const glyphRow* rows, int rowCount)
+        : representation(r), width(w), height(h), data(rows, rowCount),
+          dataWidth(widestRow(rows, rowCount)), dataHeight(rowCount) {}
 
     /* Print glyph to stdout (UTF-8 conversion) */
     void print() const {
+        std::string out;
+        char bytes[4];
         for (const auto & row : data) {
-            std::cout << to_utf8(row) << '\n';
+            for (int i = 0; i < row.length(); ++i)
+                out.append(bytes, static_cast<size_t>(encode_utf8(row[i], bytes)));
+            out += '\n';
         }
+        std::cout << out;
     }
 
     /* Public members kept for compatibility with the rest of the code */
     char representation;
     int width;
     int height;
-    std::vector<std::u32string> data;
+    glyphRows data;
+
+    int dataWidth;
+    int dataHeight;
+
+private:
+    static constexpr int widestRow(const glyphRow* rows, int count) {
+        int widest = 0;
+        for (int i = 0; i < count; ++i)
+            if (rows[i].length() > widest) widest = rows[i].length();
+        return widest;
+    }
 };
 
 /* --------------------------------------------------------------------------
    Font - collection of Character glyphs
    -------------------------------------------------------------------------- */
 /*
- * Font
+ * glyphDefinition - an owning glyph description, for fonts built at runtime.
+ */
+struct glyphDefinition {
+    char representation;
+    int width;
+    int height;
+    std::vector<std::u32string> data;
+};
+
+/*
+ * fontAtlas
+ *
+ * Every glyph row of a font packed into one contiguous array of
+ * encodedGlyphs, with a per-glyph table of row offsets and lengths.
+ * Drawing a glyph row is then one clipped copy of pre-encoded cells
+ * (see cellGrid::blitGlyphs) instead of a bounds check and a UTF-8
+ * encode per codepoint.
  *
- * A small wrapper around a vector of Character glyphs.
- * Operator[] overloads return pointers to glyphs by ASCII identifier, or nullptr.
+ * Glyphs are addressed by their position in the Font (Font::indexOf).
+ * Lazily loaded fonts start with empty slots and add() glyphs as they
+ * are parsed.
  */
-class Font {
+class fontAtlas {
 public:
-    explicit Font(const std::vector<Character>& arr) : characters(arr) {}
+    struct rowSpan {
+        const encodedGlyph* cells;
+        int length;
+    };
 
-    void printChar(int index) const {
-        if (index >= 0 && index < static_cast<int>(characters.size()))
-            characters[index].print();
-        else
-            std::cerr << "Invalid character index: " << index << std::endl;
-    }
+    explicit fontAtlas(size_t count) : glyphs_(count, glyphEntry{ 0, 0 }) {}
 
-    void printChar(char c) const {
-        for (const auto & ch : characters) {
-            if (c == ch.representation) {
-                ch.print();
-                break;
-            }
+    fontAtlas(const Character* glyphs, size_t count) : fontAtlas(count) {
+        size_t total_rows = 0, total_cells = 0;
+        for (size_t g = 0; g < count; ++g) {
+            total_rows += static_cast<size_t>(glyphs[g].data.size());
+            for (const glyphRow & row : glyphs[g].data) total_cells += static_cast<size_t>(row.size());
         }
-    }
 
-    void printString(const std::string & str) const {
-        for (char c : str) printChar(c);
+        cells_.reserve(total_cells);
+        rows_.reserve(total_rows);
+        for (size_t g = 0; g < count; ++g) add(g, glyphs[g]);
     }
 
-    const Character* operator[](char identifier) const {
-        for (const auto& ch : characters)
-            if (ch.representation == identifier)
-                return &ch;
-        return nullptr;
+    /* Pack the rows of glyph ch into slot g */
+    void add(size_t g, const Character& ch) {
+        glyphs_[g] = glyphEntry{ rows_.size(), ch.data.size() };
+        for (const glyphRow & row : ch.data) {
+            rows_.push_back(rowEntry{ cells_.size(), static_cast<size_t>(row.size()) });
+            for (int i = 0; i < row.size(); ++i) cells_.emplace_back(row[i]);
+        }
     }
 
-    Character* operator[](char identifier) {
-        for (auto& ch : characters)
-            if (ch.representation == identifier)
-                return &ch;
-        return nullptr;
+    /* Number of rows stored for glyph g (its row count, not its declared height) */
+    int rowCount(size_t g) const noexcept { return glyphs_[g].rowCount; }
+
+    rowSpan row(size_t g, int r) const noexcept {
+        const rowEntry & e = rows_[glyphs_[g].firstRow + static_cast<size_t>(r)];
+        return { cells_.data() + e.offset, static_cast<int>(e.length) };
     }
 
-    std::vector<Character> characters;
+private:
+    struct glyphEntry {
+        size_t firstRow;
+        int rowCount;
+    };
+    struct rowEntry {
+        size_t offset;
+        size_t length;
+    };
+
+    std::vector<encodedGlyph> cells_;
+    std::vector<rowEntry> rows_;
+    std::vector<glyphEntry> glyphs_;
 };
 
 /* --------------------------------------------------------------------------
-   Built-in fonts container placeholder
-   - keep same shape as original file: a const vector named 'fonts'
-   - replace the placeholder with your actual font definitions
+   FIGlet fonts
+   - .flf files are memory-mapped; glyphs are parsed on first use
    -------------------------------------------------------------------------- */
 /*
- * fonts - placeholder for your full font data.
- * Replace the comment inside the braces with the actual Font initializers.
+ * mappedFile - a read-only memory mapping of a whole file (RAII).
  */
-const std::vector < Font > fonts = {
-  Font({
-    {
-      'A',
-      7,
-      10,
-      {
-        U"    ▄▄    ",
-        U"   ████   ",
-        U"   ████   ",
-        U"  ██  ██  ",
-        U"  ██████  ",
-        U" ▄██  ██▄ ",
-        U" ▀▀    ▀▀ ",
-        U"          ",
-        U"          ",
-      }
-    },
+class mappedFile {
+public:
+    mappedFile() : data_(nullptr), size_(0) {}
+    mappedFile(const mappedFile&) = delete;
+    mappedFile& operator=(const mappedFile&) = delete;
+    ~mappedFile() { close(); }
 
-    {
-      'B',
-      7,
-      10,
-      {
-        U" ▄▄▄▄▄▄   ",
-        U" ██▀▀▀▀██ ",
-        U" ██    ██ ",
-        U" ███████  ",
-        U" ██    ██ ",
-        U" ██▄▄▄▄██ ",
-        U" ▀▀▀▀▀▀▀  ",
-        U"          ",
-        U"          ",
-      }
-    },
+    bool open(const std::string & path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER file_size;
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) return false;
+        data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (data_ == nullptr) return false;
+        size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        data_ = static_cast<const char*>(mapped);
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
 
+    void close() {
+        if (data_ == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
+/*
+ * figletFile
+ *
+ * The shared state behind a Font loaded with loadFigletFont(). open()
+ * maps the file, reads the header and records where each glyph starts
+ * (a newline scan, nothing is decoded). glyph(code) parses that glyph on
+ * first use: UTF-8 is decoded, endmarks stripped and hardblanks turned
+ * into spaces. The result is cached and packed into the font's atlas.
+ *
+ * Only codes 0-255 are kept, since Font is indexed by char: the 95
+ * required ASCII glyphs, the 7 Deutsch glyphs (as Latin-1) and any
+ * code-tagged glyph in that range.
+ */
+class figletFile {
+public:
+    enum : size_t { GLYPH_SLOTS = 256 };
+
+    figletFile()
+        : hardblank_('$'), height_(0),
+          slots_(GLYPH_SLOTS, Character(0, 0, 0, nullptr, 0)),
+          atlas_(std::make_shared<fontAtlas>(static_cast<size_t>(GLYPH_SLOTS)))
+    {
+        offsets_.fill(static_cast<size_t>(NOT_PRESENT));
+        state_.fill(UNPARSED);
+    }
+
+    /* Map path and index its glyphs; false if it is not a FIGlet font */
+    bool open(const std::string & path) {
+        if (!file_.open(path)) return false;
+        size_t pos = 0;
+
+        /* Header: flf2a<hardblank> height baseline max_length old_layout comment_lines ... */
+        std::string header;
+        if (!nextLine(pos, header) || header.compare(0, 5, "flf2a") != 0 || header.size() < 6)
+            return false;
+        hardblank_ = header[5];
+
+        long values[5] = { 0, 0, 0, 0, 0 };
+        const char* p = header.c_str() + 6;
+        for (long & value : values) {
+            char* next = nullptr;
+            value = std::strtol(p, &next, 10);
+            if (next == p) return false;
+            p = next;
+        }
+        height_ = static_cast<int>(values[0]);
+        if (height_ <= 0) return false;
+
+        std::string line;
+        for (long i = 0; i < values[4]; ++i)
+            if (!nextLine(pos, line)) return false;
+
+        /* Required glyphs: ASCII 32-126, then the Deutsch set */
+        static const int deutsch[] = { 196, 214, 220, 228, 246, 252, 223 };
+        for (int code = 32; code <= 126; ++code)
+            if (!indexGlyph(code, pos)) return true;
+        for (int code : deutsch)
+            if (!indexGlyph(code, pos)) return true;
+
+        /* Code-tagged glyphs: a line with the code, then the glyph rows */
+        while (nextLine(pos, line)) {
+            const char* tag = line.c_str();
+            while (*tag == ' ') ++tag;
+            char* end = nullptr;
+            const long code = std::strtol(tag, &end, 0);
+            if (end == tag) break;
+            if (code >= 0 && code < static_cast<long>(GLYPH_SLOTS)) {
+                if (!indexGlyph(static_cast<int>(code), pos)) break;
+            } else if (!skipRows(pos)) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    int height() const noexcept { return height_; }
+    const Character* slots() const noexcept { return slots_.data(); }
+    const std::shared_ptr<fontAtlas> & atlas() const noexcept { return atlas_; }
+
+    /* The glyph for code, parsed on first call; nullptr if the font lacks it */
+    const Character* glyph(unsigned char code) {
+        if (state_[code] == UNPARSED) parse(code);
+        return state_[code] == PARSED ? &slots_[code] : nullptr;
+    }
+
+private:
+    enum : size_t { NOT_PRESENT = static_cast<size_t>(-1) };
+    enum glyphState : unsigned char { UNPARSED, PARSED, MISSING };
+
+    /* Row storage for one parsed glyph; rows point into text */
+    struct parsedGlyph {
+        std::u32string text;
+        std::vector<glyphRow> rows;
+    };
+
+    bool nextLine(size_t & pos, std::string & line) const {
+        if (pos >= file_.size()) return false;
+        const char* begin = file_.data() + pos;
+        const void* nl = std::memchr(begin, '\n', file_.size() - pos);
+        const size_t length = nl ? static_cast<size_t>(static_cast<const char*>(nl) - begin)
+                                 : file_.size() - pos;
+        line.assign(begin, length);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        pos += length + (nl ? 1 : 0);
+        return true;
+    }
+
+    bool skipRows(size_t & pos) const {
+        for (int r = 0; r < height_; ++r) {
+            if (pos >= file_.size()) return false;
+            const void* nl = std::memchr(file_.data() + pos, '\n', file_.size() - pos);
+            pos = nl ? static_cast<size_t>(static_cast<const char*>(nl) - file_.data()) + 1 : file_.size();
+        }
+        return true;
+    }
+
+    /* Remember where glyph code starts and step over its rows */
+    bool indexGlyph(int code, size_t & pos) {
+        const size_t start = pos;
+        if (!skipRows(pos)) return false;
+        if (offsets_[static_cast<size_t>(code)] == NOT_PRESENT)
+            offsets_[static_cast<size_t>(code)] = start;
+        return true;
+    }
+
+    void parse(unsigned char code) {
+        state_[code] = MISSING;
+        size_t pos = offsets_[code];
+        if (pos == NOT_PRESENT) return;
+
+        std::unique_ptr<parsedGlyph> built(new parsedGlyph());
+        std::vector<size_t> row_start, row_length;
+        std::string line;
+        for (int r = 0; r < height_ && nextLine(pos, line); ++r) {
+            /* Strip the endmark: every trailing copy of the line's last character */
+            if (!line.empty()) {
+                const char endmark = line.back();
+                while (!line.empty() && line.back() == endmark) line.pop_back();
+            }
+            std::u32string decoded = from_utf8(line);
+            for (char32_t & c : decoded)
+                if (c == static_cast<unsigned char>(hardblank_)) c = U' ';
+
+            row_start.push_back(built->text.size());
+            row_length.push_back(decoded.size());
+            built->text += decoded;
+        }
+
+        built->rows.reserve(row_start.size());
+        for (size_t r = 0; r < row_start.size(); ++r)
+            built->rows.emplace_back(built->text.data() + row_start[r], static_cast<int>(row_length[r]));
+
+        slots_[code] = Character(static_cast<char>(code), 0, height_,
+                                 built->rows.data(), static_cast<int>(built->rows.size()));
+        slots_[code].width = slots_[code].dataWidth;
+        atlas_->add(code, slots_[code]);
+        parsed_[code] = std::move(built);
+        state_[code] = PARSED;
+    }
+
+    mappedFile file_;
+    char hardblank_;
+    int height_;
+    std::array<size_t, GLYPH_SLOTS> offsets_;
+    std::array<glyphState, GLYPH_SLOTS> state_;
+    std::array<std::unique_ptr<parsedGlyph>, GLYPH_SLOTS> parsed_;
+    std::vector<Character> slots_;
+    std::shared_ptr<fontAtlas> atlas_;
+};
+
+/*
+ * Font
+ *
+ * A view over an array of Character glyphs plus a dense 256-entry index
+ * from character code to glyph, so operator[] is one array access.
+ *
+ * Built-in fonts view the static tables in builtinFontData and allocate
+ * nothing. Fonts made from glyphDefinitions copy the rows into one shared,
+ * immutable block, so copies of the Font stay cheap and valid.
+ */
+class Font {
+public:
+    template <size_t N>
+    explicit Font(const Character (&glyphs)[N]) : Font(glyphs, N) {}
+
+    Font(const Character* glyphs, size_t count) : glyphs_(glyphs), count_(count) {
+        buildIndex();
+    }
+
+    /* A lazily parsed FIGlet font; see loadFigletFont() */
+    explicit Font(const std::shared_ptr<figletFile>& file)
+        : glyphs_(file->slots()), count_(figletFile::GLYPH_SLOTS),
+          atlas_(file->atlas()), figlet_(file)
     {
-      'C',
-      7,
-      10,
-      {
-        U"    ▄▄▄▄  ",
-        U"  ██▀▀▀▀█ ",
-        U" ██▀      ",
-        U" ██       ",
-        U" ██▄      ",
-        U"  ██▄▄▄▄█ ",
-        U"    ▀▀▀▀  ",
-        U"          ",
-        U"          ",
-      }
-    },
-    {
-      'D',
-      7,
-      10,
-      {
+        index_.fill(nullptr);
+    }
+
+    explicit Font(const std::vector<glyphDefinition>& definitions) : glyphs_(nullptr), count_(0) {
+        auto built = std::make_shared<storage>();
+
+        size_t total_rows = 0, total_chars = 0;
+        for (const auto & def : definitions) {
+            total_rows += def.data.size();
+            for (const auto & row : def.data) total_chars += row.size();
+        }
+
+        /* Reserve up front: rows and glyphs point into these buffers */
+        built->text.reserve(total_chars);
+        built->rows.reserve(total_rows);
+        built->glyphs.reserve(definitions.size());
+
+        for (const auto & def : definitions) {
+            const size_t first_row = built->rows.size();
+            for (const auto & row : def.data) {
+                const char32_t* text = built->text.data() + built->text.size();
+                built->text.insert(built->text.end(), row.begin(), row.end());
+                built->rows.emplace_back(text, static_cast<int>(row.size()));
+            }
+            built->glyphs.emplace_back(def.representation, def.width, def.height,
+                                       built->rows.data() + first_row,
+                                       static_cast<int>(def.data.size()));
+        }
+
+        glyphs_ = built->glyphs.data();
+        count_ = built->glyphs.size();
+        storage_ = built;
+        buildIndex();
+    }
+
+    size_t size() const noexcept { return count_; }
+    const Character* begin() const noexcept { return glyphs_; }
+    const Character* end() const noexcept { return glyphs_ + count_; }
+
+    void printChar(int index) const {
+        if (index >= 0 && index < static_cast<int>(count_))
+            glyphs_[index].print();
+        else
+            std::cerr << "Invalid character index: " << index << std::endl;
+    }
+
+    void printChar(char c) const {
+        if (const Character* ch = (*this)[c]) ch->print();
+    }
+
+    void printString(const std::string & str) const {
+        for (char c : str) printChar(c);
+    }
+
+    const Character* operator[](char identifier) const {
+        const unsigned char code = static_cast<unsigned char>(identifier);
+        if (index_[code] == nullptr && figlet_) index_[code] = figlet_->glyph(code);
+        return index_[code];
+    }
+
+    enum : size_t { npos = ~static_cast<size_t>(0) };
+
+    /* Position of a glyph of this font, as used by fontAtlas; npos for any other pointer */
+    size_t indexOf(const Character* glyph) const noexcept {
+        const std::less<const Character*> before;
+        if (glyph == nullptr || before(glyph, glyphs_) || !before(glyph, glyphs_ + count_))
+            return npos;
+        return static_cast<size_t>(glyph - glyphs_);
+    }
+
+    /* Packed, pre-encoded glyph rows; built on first use and shared by copies */
+    const fontAtlas& atlas() const {
+        if (!atlas_) atlas_ = std::make_shared<const fontAtlas>(glyphs_, count_);
+        return *atlas_;
+    }
+
+private:
+    /* First glyph wins when a representation appears twice */
+    void buildIndex() {
+        index_.fill(nullptr);
+        for (size_t i = count_; i-- > 0; )
+            index_[static_cast<unsigned char>(glyphs_[i].representation)] = &glyphs_[i];
+    }
+
+    struct storage {
+        std::vector<char32_t> text;
+        std::vector<glyphRow> rows;
+        std::vector<Character> glyphs;
+    };
+
+    const Character* glyphs_;
+    size_t count_;
+    std::shared_ptr<const storage> storage_;
+    mutable std::array<const Character*, 256> index_;
+    mutable std::shared_ptr<const fontAtlas> atlas_;
+    std::shared_ptr<figletFile> figlet_;
+};
+
+/*
+ * loadFigletFont(path) -> Font
+ *
+ * Maps a FIGlet .flf font; glyphs are parsed the first time they are
+ * looked up. On failure it reports to std::cerr and returns an empty
+ * Font, which draws nothing. Keep the Font alive while a subMenu uses it
+ * (subMenu::setFont stores a pointer, as for the built-in fonts).
+ */
+inline Font loadFigletFont(const std::string & path) {
+    auto file = std::make_shared<figletFile>();
+    if (!file->open(path)) {
+        std::cerr << "Could not load FIGlet font: " << path << std::endl;
+        return Font(static_cast<const Character*>(nullptr), 0);
+    }
+    return Font(file);
+}
+
+/* --------------------------------------------------------------------------
+   Built-in font data
+   - laid out at compile time: per font, one table of glyph rows and one
+     table of Characters viewing into it; nothing is allocated at startup
+   -------------------------------------------------------------------------- */
+namespace builtinFontData {
+    constexpr glyphRow Mono12Rows[] = {
+        /* 'A' */
+        U"    ▄▄    ",
+        U"   ████   ",
+        U"   ████   ",
+        U"  ██  ██  ",
+        U"  ██████  ",
+        U" ▄██  ██▄ ",
+        U" ▀▀    ▀▀ ",
+        U"          ",
+        U"          ",
+        /* 'B' */
+        U" ▄▄▄▄▄▄   ",
+        U" ██▀▀▀▀██ ",
+        U" ██    ██ ",
+        U" ███████  ",
+        U" ██    ██ ",
+        U" ██▄▄▄▄██ ",
+        U" ▀▀▀▀▀▀▀  ",
+        U"          ",
+        U"          ",
+        /* 'C' */
+        U"    ▄▄▄▄  ",
+        U"  ██▀▀▀▀█ ",
+        U" ██▀      ",
+        U" ██       ",
+        U" ██▄      ",
+        U"  ██▄▄▄▄█ ",
+        U"    ▀▀▀▀  ",
+        U"          ",
+        U"          ",
+        /* 'D' */
         U" ▄▄▄▄▄    ",
         U" ██▀▀▀██  ",
         U" ██    ██ ",
@@ -413,13 +1397,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀▀▀    ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'E',
-      7,
-      10,
-      {
+        /* 'E' */
         U" ▄▄▄▄▄▄▄▄ ",
         U" ██▀▀▀▀▀▀ ",
         U" ██       ",
@@ -429,13 +1407,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀▀▀▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'F',
-      7,
-      10,
-      {
+        /* 'F' */
         U" ▄▄▄▄▄▄▄▄ ",
         U" ██▀▀▀▀▀▀ ",
         U" ██       ",
@@ -445,13 +1417,7 @@ const std::vector < Font > fonts = {
         U" ▀▀       ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'G',
-      7,
-      10,
-      {
+        /* 'G' */
         U"    ▄▄▄▄  ",
         U"  ██▀▀▀▀█ ",
         U" ██       ",
@@ -461,13 +1427,7 @@ const std::vector < Font > fonts = {
         U"    ▀▀▀▀  ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'H',
-      7,
-      10,
-      {
+        /* 'H' */
         U" ▄▄    ▄▄ ",
         U" ██    ██ ",
         U" ██    ██ ",
@@ -477,13 +1437,7 @@ const std::vector < Font > fonts = {
         U" ▀▀    ▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'I',
-      7,
-      10,
-      {
+        /* 'I' */
         U"  ▄▄▄▄▄▄  ",
         U"  ▀▀██▀▀  ",
         U"    ██    ",
@@ -493,13 +1447,7 @@ const std::vector < Font > fonts = {
         U"  ▀▀▀▀▀▀  ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'J',
-      7,
-      10,
-      {
+        /* 'J' */
         U"    ▄▄▄▄▄ ",
         U"    ▀▀▀██ ",
         U"       ██ ",
@@ -509,13 +1457,7 @@ const std::vector < Font > fonts = {
         U"  ▀▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'K',
-      7,
-      10,
-      {
+        /* 'K' */
         U" ▄▄   ▄▄▄ ",
         U" ██  ██▀  ",
         U" ██▄██    ",
@@ -525,13 +1467,7 @@ const std::vector < Font > fonts = {
         U" ▀▀    ▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'L',
-      7,
-      10,
-      {
+        /* 'L' */
         U" ▄▄       ",
         U" ██       ",
         U" ██       ",
@@ -541,13 +1477,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀▀▀▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'M',
-      7,
-      10,
-      {
+        /* 'M' */
         U" ▄▄▄  ▄▄▄ ",
         U" ███  ███ ",
         U" ████████ ",
@@ -557,13 +1487,7 @@ const std::vector < Font > fonts = {
         U" ▀▀    ▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'N',
-      7,
-      10,
-      {
+        /* 'N' */
         U" ▄▄▄   ▄▄ ",
         U" ███   ██ ",
         U" ██▀█  ██ ",
@@ -573,13 +1497,7 @@ const std::vector < Font > fonts = {
         U" ▀▀   ▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'O',
-      7,
-      10,
-      {
+        /* 'O' */
         U"   ▄▄▄▄   ",
         U"  ██▀▀██  ",
         U" ██    ██ ",
@@ -589,13 +1507,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'P',
-      7,
-      10,
-      {
+        /* 'P' */
         U" ▄▄▄▄▄▄   ",
         U" ██▀▀▀▀█▄ ",
         U" ██    ██ ",
@@ -605,13 +1517,7 @@ const std::vector < Font > fonts = {
         U" ▀▀       ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'Q',
-      7,
-      10,
-      {
+        /* 'Q' */
         U"   ▄▄▄▄   ",
         U"  ██▀▀██  ",
         U" ██    ██ ",
@@ -621,13 +1527,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀██  ",
         U"       ▀  ",
         U"          ",
-      }
-    },
-    {
-      'R',
-      7,
-      10,
-      {
+        /* 'R' */
         U" ▄▄▄▄▄▄   ",
         U" ██▀▀▀▀██ ",
         U" ██    ██ ",
@@ -637,13 +1537,7 @@ const std::vector < Font > fonts = {
         U" ▀▀    ▀▀▀",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'S',
-      7,
-      10,
-      {
+        /* 'S' */
         U"   ▄▄▄▄   ",
         U" ▄█▀▀▀▀█  ",
         U" ██▄      ",
@@ -653,13 +1547,7 @@ const std::vector < Font > fonts = {
         U"  ▀▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'T',
-      7,
-      10,
-      {
+        /* 'T' */
         U" ▄▄▄▄▄▄▄▄ ",
         U" ▀▀▀██▀▀▀ ",
         U"    ██    ",
@@ -669,13 +1557,7 @@ const std::vector < Font > fonts = {
         U"    ▀▀    ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'U',
-      7,
-      10,
-      {
+        /* 'U' */
         U" ▄▄    ▄▄ ",
         U" ██    ██ ",
         U" ██    ██ ",
@@ -685,13 +1567,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'V',
-      7,
-      10,
-      {
+        /* 'V' */
         U" ▄▄    ▄▄ ",
         U" ▀██  ██▀ ",
         U"  ██  ██  ",
@@ -701,13 +1577,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'W',
-      7,
-      10,
-      {
+        /* 'W' */
         U"▄▄      ▄▄",
         U"██      ██",
         U"▀█▄ ██ ▄█▀",
@@ -717,13 +1587,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀  ▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'X',
-      7,
-      10,
-      {
+        /* 'X' */
         U" ▄▄▄  ▄▄▄ ",
         U"  ██▄▄██  ",
         U"   ████   ",
@@ -733,13 +1597,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀  ▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'Y',
-      7,
-      10,
-      {
+        /* 'Y' */
         U"▄▄▄    ▄▄▄",
         U" ██▄  ▄██ ",
         U"  ██▄▄██  ",
@@ -749,13 +1607,7 @@ const std::vector < Font > fonts = {
         U"    ▀▀    ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      'Z',
-      7,
-      10,
-      {
+        /* 'Z' */
         U" ▄▄▄▄▄▄▄▄ ",
         U" ▀▀▀▀▀███ ",
         U"     ██▀  ",
@@ -765,13 +1617,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀▀▀▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '1',
-      7,
-      10,
-      {
+        /* '1' */
         U"   ▄▄▄    ",
         U"  █▀██    ",
         U"    ██    ",
@@ -781,13 +1627,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀▀▀▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '2',
-      7,
-      10,
-      {
+        /* '2' */
         U"  ▄▄▄▄▄   ",
         U" █▀▀▀▀██▄ ",
         U"       ██ ",
@@ -797,13 +1637,7 @@ const std::vector < Font > fonts = {
         U" ▀▀▀▀▀▀▀▀ ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '3',
-      7,
-      10,
-      {
+        /* '3' */
         U"  ▄▄▄▄▄   ",
         U" █▀▀▀▀██▄ ",
         U"      ▄██ ",
@@ -813,13 +1647,7 @@ const std::vector < Font > fonts = {
         U"  ▀▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '4',
-      7,
-      10,
-      {
+        /* '4' */
         U"     ▄▄▄  ",
         U"    ▄███  ",
         U"   █▀ ██  ",
@@ -829,13 +1657,7 @@ const std::vector < Font > fonts = {
         U"      ▀▀  ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '5',
-      7,
-      10,
-      {
+        /* '5' */
         U" ▄▄▄▄▄▄▄  ",
         U" ██▀▀▀▀▀  ",
         U" ██▄▄▄▄   ",
@@ -845,13 +1667,7 @@ const std::vector < Font > fonts = {
         U"  ▀▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '6',
-      7,
-      10,
-      {
+        /* '6' */
         U"   ▄▄▄▄   ",
         U"  ██▀▀▀█  ",
         U" ██ ▄▄▄   ",
@@ -861,13 +1677,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '7',
-      7,
-      10,
-      {
+        /* '7' */
         U" ▄▄▄▄▄▄▄▄ ",
         U" ▀▀▀▀▀███ ",
         U"     ▄██  ",
@@ -877,13 +1687,7 @@ const std::vector < Font > fonts = {
         U"  ▀▀      ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '8',
-      7,
-      10,
-      {
+        /* '8' */
         U"   ▄▄▄▄   ",
         U" ▄██▀▀██▄ ",
         U" ██▄  ▄██ ",
@@ -893,13 +1697,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '9',
-      7,
-      10,
-      {
+        /* '9' */
         U"   ▄▄▄▄   ",
         U" ▄██▀▀██▄ ",
         U" ██    ██ ",
@@ -909,13 +1707,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '0',
-      7,
-      10,
-      {
+        /* '0' */
         U"   ▄▄▄▄   ",
         U"  ██▀▀██  ",
         U" ██    ██ ",
@@ -925,13 +1717,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀   ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '!',
-      7,
-      10,
-      {
+        /* '!' */
         U"    ▄▄    ",
         U"    ██    ",
         U"    ██    ",
@@ -941,13 +1727,7 @@ const std::vector < Font > fonts = {
         U"    ▀▀    ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '@',
-      7,
-      10,
-      {
+        /* '@' */
         U"          ",
         U"  ▄████▄  ",
         U"▄██▀  ▀██ ",
@@ -957,13 +1737,7 @@ const std::vector < Font > fonts = {
         U" ▀██▄▄▄█▄ ",
         U"   ▀▀▀▀▀  ",
         U"          ",
-      }
-    },
-    {
-      '#',
-      7,
-      10,
-      {
+        /* '#' */
         U"    ▄▄ ▄▄ ",
         U"   ▄█  ██ ",
         U" █████████",
@@ -973,13 +1747,7 @@ const std::vector < Font > fonts = {
         U" ▀▀  ▀    ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '$',
-      7,
-      10,
-      {
+        /* '$' */
         U"    ▄     ",
         U"  ▄▄█▄▄   ",
         U" ██▀█▀▀   ",
@@ -989,13 +1757,7 @@ const std::vector < Font > fonts = {
         U"  ▀▀█▀▀   ",
         U"    ▀     ",
         U"          ",
-      }
-    },
-    {
-      '%',
-      7,
-      10,
-      {
+        /* '%' */
         U" ▄▄▄      ",
         U"█   █     ",
         U"▀▄▄▄▀  ▄  ",
@@ -1005,13 +1767,7 @@ const std::vector < Font > fonts = {
         U"     ▀▀▀  ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '^',
-      7,
-      10,
-      {
+        /* '^' */
         U"   ▄▄▄    ",
         U" ▄██▀██▄  ",
         U"▀▀▀   ▀▀▀ ",
@@ -1021,13 +1777,7 @@ const std::vector < Font > fonts = {
         U"          ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '&',
-      7,
-      10,
-      {
+        /* '&' */
         U"   ▄▄▄▄   ",
         U"  ██▀▀▀█  ",
         U"  ▀█▄     ",
@@ -1037,13 +1787,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀▀▀▀▀▀",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '*',
-      7,
-      10,
-      {
+        /* '*' */
         U"    ▄     ",
         U" ▄▄ █ ▄▄  ",
         U"  █████   ",
@@ -1053,13 +1797,7 @@ const std::vector < Font > fonts = {
         U"          ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '(',
-      7,
-      10,
-      {
+        /* '(' */
         U"     ▄▄   ",
         U"    ██    ",
         U"   ▄█▀    ",
@@ -1069,13 +1807,7 @@ const std::vector < Font > fonts = {
         U"    ██    ",
         U"     ▀▀   ",
         U"          ",
-      }
-    },
-    {
-      ')',
-      7,
-      10,
-      {
+        /* ')' */
         U"  ▄▄      ",
         U"   ██     ",
         U"   ▀█▄    ",
@@ -1085,13 +1817,7 @@ const std::vector < Font > fonts = {
         U"   ██     ",
         U"  ▀▀      ",
         U"          ",
-      }
-    },
-    {
-      '[',
-      7,
-      10,
-      {
+        /* '[' */
         U"   ▄▄▄▄   ",
         U"   ██     ",
         U"   ██     ",
@@ -1101,13 +1827,7 @@ const std::vector < Font > fonts = {
         U"   ██     ",
         U"   ▀▀▀▀   ",
         U"          ",
-      }
-    },
-    {
-      ']',
-      7,
-      10,
-      {
+        /* ']' */
         U"  ▄▄▄▄    ",
         U"    ██    ",
         U"    ██    ",
@@ -1117,13 +1837,7 @@ const std::vector < Font > fonts = {
         U"    ██    ",
         U"  ▀▀▀▀    ",
         U"          ",
-      }
-    },
-    {
-      '?',
-      7,
-      10,
-      {
+        /* '?' */
         U"  ▄▄▄▄▄   ",
         U" █▀▀▀▀██  ",
         U"     ▄█▀  ",
@@ -1133,13 +1847,7 @@ const std::vector < Font > fonts = {
         U"   ▀▀     ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '>',
-      7,
-      10,
-      {
+        /* '>' */
         U"          ",
         U"          ",
         U" █▄▄▄     ",
@@ -1149,13 +1857,7 @@ const std::vector < Font > fonts = {
         U"          ",
         U"          ",
         U"          ",
-      }
-    },
-    {
-      '<',
-      7,
-      10,
-      {
+        /* '<' */
         U"          ",
         U"          ",
         U"     ▄▄▄█ ",
@@ -1165,15 +1867,64 @@ const std::vector < Font > fonts = {
         U"          ",
         U"          ",
         U"          ",
-      }
-    }
-  }),
-  Font({
-    {
-      'A',
-      10,
-      10,
-      {
+    };
+
+    constexpr Character Mono12[] = {
+        Character('A', 7, 10, Mono12Rows + 0, 9),
+        Character('B', 7, 10, Mono12Rows + 9, 9),
+        Character('C', 7, 10, Mono12Rows + 18, 9),
+        Character('D', 7, 10, Mono12Rows + 27, 9),
+        Character('E', 7, 10, Mono12Rows + 36, 9),
+        Character('F', 7, 10, Mono12Rows + 45, 9),
+        Character('G', 7, 10, Mono12Rows + 54, 9),
+        Character('H', 7, 10, Mono12Rows + 63, 9),
+        Character('I', 7, 10, Mono12Rows + 72, 9),
+        Character('J', 7, 10, Mono12Rows + 81, 9),
+        Character('K', 7, 10, Mono12Rows + 90, 9),
+        Character('L', 7, 10, Mono12Rows + 99, 9),
+        Character('M', 7, 10, Mono12Rows + 108, 9),
+        Character('N', 7, 10, Mono12Rows + 117, 9),
+        Character('O', 7, 10, Mono12Rows + 126, 9),
+        Character('P', 7, 10, Mono12Rows + 135, 9),
+        Character('Q', 7, 10, Mono12Rows + 144, 9),
+        Character('R', 7, 10, Mono12Rows + 153, 9),
+        Character('S', 7, 10, Mono12Rows + 162, 9),
+        Character('T', 7, 10, Mono12Rows + 171, 9),
+        Character('U', 7, 10, Mono12Rows + 180, 9),
+        Character('V', 7, 10, Mono12Rows + 189, 9),
+        Character('W', 7, 10, Mono12Rows + 198, 9),
+        Character('X', 7, 10, Mono12Rows + 207, 9),
+        Character('Y', 7, 10, Mono12Rows + 216, 9),
+        Character('Z', 7, 10, Mono12Rows + 225, 9),
+        Character('1', 7, 10, Mono12Rows + 234, 9),
+        Character('2', 7, 10, Mono12Rows + 243, 9),
+        Character('3', 7, 10, Mono12Rows + 252, 9),
+        Character('4', 7, 10, Mono12Rows + 261, 9),
+        Character('5', 7, 10, Mono12Rows + 270, 9),
+        Character('6', 7, 10, Mono12Rows + 279, 9),
+        Character('7', 7, 10, Mono12Rows + 288, 9),
+        Character('8', 7, 10, Mono12Rows + 297, 9),
+        Character('9', 7, 10, Mono12Rows + 306, 9),
+        Character('0', 7, 10, Mono12Rows + 315, 9),
+        Character('!', 7, 10, Mono12Rows + 324, 9),
+        Character('@', 7, 10, Mono12Rows + 333, 9),
+        Character('#', 7, 10, Mono12Rows + 342, 9),
+        Character('$', 7, 10, Mono12Rows + 351, 9),
+        Character('%', 7, 10, Mono12Rows + 360, 9),
+        Character('^', 7, 10, Mono12Rows + 369, 9),
+        Character('&', 7, 10, Mono12Rows + 378, 9),
+        Character('*', 7, 10, Mono12Rows + 387, 9),
+        Character('(', 7, 10, Mono12Rows + 396, 9),
+        Character(')', 7, 10, Mono12Rows + 405, 9),
+        Character('[', 7, 10, Mono12Rows + 414, 9),
+        Character(']', 7, 10, Mono12Rows + 423, 9),
+        Character('?', 7, 10, Mono12Rows + 432, 9),
+        Character('>', 7, 10, Mono12Rows + 441, 9),
+        Character('<', 7, 10, Mono12Rows + 450, 9),
+    };
+
+    constexpr glyphRow BloodyRows[] = {
+        /* 'A' */
         U" ▄▄▄      ",
         U"▒████▄    ",
         U"▒██  ▀█▄  ",
@@ -1184,13 +1935,7 @@ const std::vector < Font > fonts = {
         U"  ░   ▒   ",
         U"      ░  ░",
         U"          ",
-      }
-    },
-    {
-      'B',
-      10,
-      8,
-      {
+        /* 'B' */
         U" ▄▄▄▄   ",
         U"▓█████▄ ",
         U"▒██▒ ▄██",
@@ -1201,13 +1946,7 @@ const std::vector < Font > fonts = {
         U" ░    ░ ",
         U" ░      ",
         U"      ░ ",
-      }
-    },
-    {
-      'C',
-      10,
-      9,
-      {
+        /* 'C' */
         U" ▄████▄  ",
         U"▒██▀ ▀█  ",
         U"▒▓█    ▄ ",
@@ -1218,13 +1957,7 @@ const std::vector < Font > fonts = {
         U"░        ",
         U"░ ░      ",
         U"░        ",
-      }
-    },
-    {
-      'D',
-      10,
-      8,
-      {
+        /* 'D' */
         U"▓█████▄ ",
         U"▒██▀ ██▌",
         U"░██   █▌",
@@ -1235,13 +1968,7 @@ const std::vector < Font > fonts = {
         U" ░ ░  ░ ",
         U"   ░    ",
         U" ░      ",
-      }
-    },
-    {
-      'E',
-      10,
-      7,
-      {
+        /* 'E' */
         U"▓█████ ",
         U"▓█   ▀ ",
         U"▒███   ",
@@ -1252,13 +1979,7 @@ const std::vector < Font > fonts = {
         U"   ░   ",
         U"   ░  ░",
         U"       ",
-      }
-    },
-    {
-      'F',
-      10,
-      8,
-      {
+        /* 'F' */
         U"  █████▒",
         U"▓██   ▒ ",
         U"▒████ ░ ",
@@ -1269,13 +1990,7 @@ const std::vector < Font > fonts = {
         U" ░ ░    ",
         U"        ",
         U"        ",
-      }
-    },
-    {
-      'G',
-      10,
-      8,
-      {
+        /* 'G' */
         U"  ▄████ ",
         U" ██▒ ▀█▒",
         U"▒██░▄▄▄░",
@@ -1286,13 +2001,7 @@ const std::vector < Font > fonts = {
         U"░ ░   ░ ",
         U"      ░ ",
         U"        ",
-      }
-    },
-    {
-      'H',
-      10,
-      8,
-      {
+        /* 'H' */
         U" ██░ ██ ",
         U"▓██░ ██▒",
         U"▒██▀▀██░",
@@ -1303,13 +2012,7 @@ const std::vector < Font > fonts = {
         U" ░  ░░ ░",
         U" ░  ░  ░",
         U"        ",
-      }
-    },
-    {
-      'I',
-      10,
-      4,
-      {
+        /* 'I' */
         U" ██▓",
         U"▓██▒",
         U"▒██▒",
@@ -1320,13 +2023,7 @@ const std::vector < Font > fonts = {
         U" ▒ ░",
         U" ░  ",
         U"    ",
-      }
-    },
-    {
-      'J',
-      10,
-      9,
-      {
+        /* 'J' */
         U" ▄▄▄██▀▀▀",
         U"   ▒██   ",
         U"   ░██   ",
@@ -1337,13 +2034,7 @@ const std::vector < Font > fonts = {
         U" ░ ░ ░   ",
         U" ░   ░   ",
         U"         ",
-      }
-    },
-    {
-      'K',
-      10,
-      7,
-      {
+        /* 'K' */
         U" ██ ▄█▀",
         U" ██▄█▒ ",
         U"▓███▄░ ",
@@ -1354,13 +2045,7 @@ const std::vector < Font > fonts = {
         U"░ ░░ ░ ",
         U"░  ░   ",
         U"       ",
-      }
-    },
-    {
-      'L',
-      10,
-      8,
-      {
+        /* 'L' */
         U" ██▓    ",
         U"▓██▒    ",
         U"▒██░    ",
@@ -1371,13 +2056,7 @@ const std::vector < Font > fonts = {
         U"  ░ ░   ",
         U"    ░  ░",
         U"        ",
-      }
-    },
-    {
-      'M',
-      10,
-      11,
-      {
+        /* 'M' */
         U" ███▄ ▄███▓",
         U"▓██▒▀█▀ ██▒",
         U"▓██    ▓██░",
@@ -1388,13 +2067,7 @@ const std::vector < Font > fonts = {
         U"░      ░   ",
         U"       ░   ",
         U"           ",
-      }
-    },
-    {
-      'N',
-      10,
-      11,
-      {
+        /* 'N' */
         U" ███▄    █ ",
         U" ██ ▀█   █ ",
         U"▓██  ▀█ ██▒",
@@ -1405,13 +2078,7 @@ const std::vector < Font > fonts = {
         U"   ░   ░ ░ ",
         U"         ░ ",
         U"           ",
-      }
-    },
-    {
-      'O',
-      10,
-      9,
-      {
+        /* 'O' */
         U" ▒█████  ",
         U"▒██▒  ██▒",
         U"▒██░  ██▒",
@@ -1422,13 +2089,7 @@ const std::vector < Font > fonts = {
         U"░ ░ ░ ▒  ",
         U"    ░ ░  ",
         U"         ",
-      }
-    },
-    {
-      'P',
-      10,
-      9,
-      {
+        /* 'P' */
         U" ██▓███  ",
         U"▓██░  ██▒",
         U"▓██░ ██▓▒",
@@ -1439,13 +2100,7 @@ const std::vector < Font > fonts = {
         U"░░       ",
         U"         ",
         U"         ",
-      }
-    },
-    {
-      'Q',
-      10,
-      9,
-      {
+        /* 'Q' */
         U"  █████  ",
         U"▒██▓  ██▒",
         U"▒██▒  ██░",
@@ -1456,13 +2111,7 @@ const std::vector < Font > fonts = {
         U"   ░   ░ ",
         U"    ░    ",
         U"         ",
-      }
-    },
-    {
-      'R',
-      10,
-      9,
-      {
+        /* 'R' */
         U" ██▀███  ",
         U"▓██ ▒ ██▒",
         U"▓██ ░▄█ ▒",
@@ -1473,13 +2122,7 @@ const std::vector < Font > fonts = {
         U"  ░░   ░ ",
         U"   ░     ",
         U"         ",
-      }
-    },
-    {
-      'S',
-      10,
-      9,
-      {
+        /* 'S' */
         U"  ██████ ",
         U"▒██    ▒ ",
         U"░ ▓██▄   ",
@@ -1490,13 +2133,7 @@ const std::vector < Font > fonts = {
         U"░  ░  ░  ",
         U"      ░  ",
         U"         ",
-      }
-    },
-    {
-      'T',
-      10,
-      9,
-      {
+        /* 'T' */
         U"▄▄▄█████▓",
         U"▓  ██▒ ▓▒",
         U"▒ ▓██░ ▒░",
@@ -1507,13 +2144,7 @@ const std::vector < Font > fonts = {
         U"  ░      ",
         U"         ",
         U"         ",
-      }
-    },
-    {
-      'U',
-      10,
-      9,
-      {
+        /* 'U' */
         U" █    ██ ",
         U" ██  ▓██▒",
         U"▓██  ▒██░",
@@ -1524,13 +2155,7 @@ const std::vector < Font > fonts = {
         U" ░░░ ░ ░ ",
         U"   ░     ",
         U"         ",
-      }
-    },
-    {
-      'V',
-      10,
-      9,
-      {
+        /* 'V' */
         U" ██▒   █▓",
         U"▓██░   █▒",
         U" ▓██  █▒░",
@@ -1541,13 +2166,7 @@ const std::vector < Font > fonts = {
         U"     ░░  ",
         U"      ░  ",
         U"     ░   ",
-      }
-    },
-    {
-      'W',
-      10,
-      9,
-      {
+        /* 'W' */
         U" █     █░",
         U"▓█░ █ ░█░",
         U"▒█░ █ ░█ ",
@@ -1558,13 +2177,7 @@ const std::vector < Font > fonts = {
         U"  ░   ░  ",
         U"    ░    ",
         U"         ",
-      }
-    },
-    {
-      'X',
-      10,
-      9,
-      {
+        /* 'X' */
         U"▒██   ██▒",
         U"▒▒ █ █ ▒░",
         U"░░  █   ░",
@@ -1575,13 +2188,7 @@ const std::vector < Font > fonts = {
         U" ░    ░  ",
         U" ░    ░  ",
         U"         ",
-      }
-    },
-    {
-      'Y',
-      10,
-      9,
-      {
+        /* 'Y' */
         U"▓██   ██▓",
         U" ▒██  ██▒",
         U"  ▒██ ██░",
@@ -1592,13 +2199,7 @@ const std::vector < Font > fonts = {
         U" ▒ ▒ ░░  ",
         U" ░ ░     ",
         U" ░ ░     ",
-      }
-    },
-    {
-      'Z',
-      10,
-      9,
-      {
+        /* 'Z' */
         U"▒███████▒",
         U"▒ ▒ ▒ ▄▀░",
         U"░ ▒ ▄▀▒░ ",
@@ -1609,15 +2210,39 @@ const std::vector < Font > fonts = {
         U"░ ░ ░ ░ ░",
         U"  ░ ░    ",
         U"░        ",
-      }
-    }
-  }),
-  Font({
-    {
-      'A',
-      7,
-      8,
-      {
+    };
+
+    constexpr Character Bloody[] = {
+        Character('A', 10, 10, BloodyRows + 0, 10),
+        Character('B', 10, 8, BloodyRows + 10, 10),
+        Character('C', 10, 9, BloodyRows + 20, 10),
+        Character('D', 10, 8, BloodyRows + 30, 10),
+        Character('E', 10, 7, BloodyRows + 40, 10),
+        Character('F', 10, 8, BloodyRows + 50, 10),
+        Character('G', 10, 8, BloodyRows + 60, 10),
+        Character('H', 10, 8, BloodyRows + 70, 10),
+        Character('I', 10, 4, BloodyRows + 80, 10),
+        Character('J', 10, 9, BloodyRows + 90, 10),
+        Character('K', 10, 7, BloodyRows + 100, 10),
+        Character('L', 10, 8, BloodyRows + 110, 10),
+        Character('M', 10, 11, BloodyRows + 120, 10),
+        Character('N', 10, 11, BloodyRows + 130, 10),
+        Character('O', 10, 9, BloodyRows + 140, 10),
+        Character('P', 10, 9, BloodyRows + 150, 10),
+        Character('Q', 10, 9, BloodyRows + 160, 10),
+        Character('R', 10, 9, BloodyRows + 170, 10),
+        Character('S', 10, 9, BloodyRows + 180, 10),
+        Character('T', 10, 9, BloodyRows + 190, 10),
+        Character('U', 10, 9, BloodyRows + 200, 10),
+        Character('V', 10, 9, BloodyRows + 210, 10),
+        Character('W', 10, 9, BloodyRows + 220, 10),
+        Character('X', 10, 9, BloodyRows + 230, 10),
+        Character('Y', 10, 9, BloodyRows + 240, 10),
+        Character('Z', 10, 9, BloodyRows + 250, 10),
+    };
+
+    constexpr glyphRow AnsiShadowRows[] = {
+        /* 'A' */
         U" █████╗ ",
         U"██╔══██╗",
         U"███████║",
@@ -1625,13 +2250,7 @@ const std::vector < Font > fonts = {
         U"██║  ██║",
         U"╚═╝  ╚═╝",
         U"        ",
-      }
-    },
-    {
-      'B',
-      7,
-      8,
-      {
+        /* 'B' */
         U"██████╗ ",
         U"██╔══██╗",
         U"██████╔╝",
@@ -1639,13 +2258,7 @@ const std::vector < Font > fonts = {
         U"██████╔╝",
         U"╚═════╝ ",
         U"        ",
-      }
-    },
-    {
-      'C',
-      7,
-      8,
-      {
+        /* 'C' */
         U" ██████╗",
         U"██╔════╝",
         U"██║     ",
@@ -1653,13 +2266,7 @@ const std::vector < Font > fonts = {
         U"╚██████╗",
         U" ╚═════╝",
         U"        ",
-      }
-    },
-    {
-      'D',
-      7,
-      8,
-      {
+        /* 'D' */
         U"██████╗ ",
         U"██╔══██╗",
         U"██║  ██║",
@@ -1667,13 +2274,7 @@ const std::vector < Font > fonts = {
         U"██████╔╝",
         U"╚═════╝ ",
         U"        ",
-      }
-    },
-    {
-      'E',
-      7,
-      8,
-      {
+        /* 'E' */
         U"███████╗",
         U"██╔════╝",
         U"█████╗  ",
@@ -1681,13 +2282,7 @@ const std::vector < Font > fonts = {
         U"███████╗",
         U"╚══════╝",
         U"        ",
-      }
-    },
-    {
-      'F',
-      7,
-      8,
-      {
+        /* 'F' */
         U"███████╗",
         U"██╔════╝",
         U"█████╗  ",
@@ -1695,13 +2290,7 @@ const std::vector < Font > fonts = {
         U"██║     ",
         U"╚═╝     ",
         U"        ",
-      }
-    },
-    {
-      'G',
-      7,
-      9,
-      {
+        /* 'G' */
         U" ██████╗ ",
         U"██╔════╝ ",
         U"██║  ███╗",
@@ -1709,13 +2298,7 @@ const std::vector < Font > fonts = {
         U"╚██████╔╝",
         U" ╚═════╝ ",
         U"         ",
-      }
-    },
-    {
-      'H',
-      7,
-      8,
-      {
+        /* 'H' */
         U"██╗  ██╗",
         U"██║  ██║",
         U"███████║",
@@ -1723,13 +2306,7 @@ const std::vector < Font > fonts = {
         U"██║  ██║",
         U"╚═╝  ╚═╝",
         U"        ",
-      }
-    },
-    {
-      'I',
-      7,
-      3,
-      {
+        /* 'I' */
         U"██╗",
         U"██║",
         U"██║",
@@ -1737,13 +2314,7 @@ const std::vector < Font > fonts = {
         U"██║",
         U"╚═╝",
         U"   ",
-      }
-    },
-    {
-      'J',
-      7,
-      8,
-      {
+        /* 'J' */
         U"     ██╗",
         U"     ██║",
         U"     ██║",
@@ -1751,13 +2322,7 @@ const std::vector < Font > fonts = {
         U"╚█████╔╝",
         U" ╚════╝ ",
         U"        ",
-      }
-    },
-    {
-      'K',
-      7,
-      8,
-      {
+        /* 'K' */
         U"██╗  ██╗",
         U"██║ ██╔╝",
         U"█████╔╝ ",
@@ -1765,13 +2330,7 @@ const std::vector < Font > fonts = {
         U"██║  ██╗",
         U"╚═╝  ╚═╝",
         U"        ",
-      }
-    },
-    {
-      'L',
-      7,
-      8,
-      {
+        /* 'L' */
         U"██╗     ",
         U"██║     ",
         U"██║     ",
@@ -1779,13 +2338,7 @@ const std::vector < Font > fonts = {
         U"███████╗",
         U"╚══════╝",
         U"        ",
-      }
-    },
-    {
-      'M',
-      7,
-      11,
-      {
+        /* 'M' */
         U"███╗   ███╗",
         U"████╗ ████║",
         U"██╔████╔██║",
@@ -1793,13 +2346,7 @@ const std::vector < Font > fonts = {
         U"██║ ╚═╝ ██║",
         U"╚═╝     ╚═╝",
         U"           ",
-      }
-    },
-    {
-      'N',
-      7,
-      10,
-      {
+        /* 'N' */
         U"███╗   ██╗",
         U"████╗  ██║",
         U"██╔██╗ ██║",
@@ -1807,13 +2354,7 @@ const std::vector < Font > fonts = {
         U"██║ ╚████║",
         U"╚═╝  ╚═══╝",
         U"          ",
-      }
-    },
-    {
-      'O',
-      7,
-      9,
-      {
+        /* 'O' */
         U" ██████╗ ",
         U"██╔═══██╗",
         U"██║   ██║",
@@ -1821,13 +2362,7 @@ const std::vector < Font > fonts = {
         U"╚██████╔╝",
         U" ╚═════╝ ",
         U"         ",
-      }
-    },
-    {
-      'P',
-      7,
-      8,
-      {
+        /* 'P' */
         U"██████╗ ",
         U"██╔══██╗",
         U"██████╔╝",
@@ -1835,13 +2370,7 @@ const std::vector < Font > fonts = {
         U"██║     ",
         U"╚═╝     ",
         U"        ",
-      }
-    },
-    {
-      'Q',
-      7,
-      9,
-      {
+        /* 'Q' */
         U" ██████╗ ",
         U"██╔═══██╗",
         U"██║   ██║",
@@ -1849,13 +2378,7 @@ const std::vector < Font > fonts = {
         U"╚██████╔╝",
         U" ╚══▀▀═╝ ",
         U"         ",
-      }
-    },
-    {
-      'R',
-      7,
-      8,
-      {
+        /* 'R' */
         U"██████╗ ",
         U"██╔══██╗",
         U"██████╔╝",
@@ -1863,13 +2386,7 @@ const std::vector < Font > fonts = {
         U"██║  ██║",
         U"╚═╝  ╚═╝",
         U"        ",
-      }
-    },
-    {
-      'S',
-      7,
-      8,
-      {
+        /* 'S' */
         U"███████╗",
         U"██╔════╝",
         U"███████╗",
@@ -1877,13 +2394,7 @@ const std::vector < Font > fonts = {
         U"███████║",
         U"╚══════╝",
         U"        ",
-      }
-    },
-    {
-      'T',
-      7,
-      9,
-      {
+        /* 'T' */
         U"████████╗",
         U"╚══██╔══╝",
         U"   ██║   ",
@@ -1891,13 +2402,7 @@ const std::vector < Font > fonts = {
         U"   ██║   ",
         U"   ╚═╝   ",
         U"         ",
-      }
-    },
-    {
-      'U',
-      7,
-      9,
-      {
+        /* 'U' */
         U"██╗   ██╗",
         U"██║   ██║",
         U"██║   ██║",
@@ -1905,13 +2410,7 @@ const std::vector < Font > fonts = {
         U"╚██████╔╝",
         U" ╚═════╝ ",
         U"         ",
-      }
-    },
-    {
-      'V',
-      7,
-      9,
-      {
+        /* 'V' */
         U"██╗   ██╗",
         U"██║   ██║",
         U"██║   ██║",
@@ -1919,13 +2418,7 @@ const std::vector < Font > fonts = {
         U" ╚████╔╝ ",
         U"  ╚═══╝  ",
         U"         ",
-      }
-    },
-    {
-      'W',
-      7,
-      10,
-      {
+        /* 'W' */
         U"██╗    ██╗",
         U"██║    ██║",
         U"██║ █╗ ██║",
@@ -1933,13 +2426,7 @@ const std::vector < Font > fonts = {
         U"╚███╔███╔╝",
         U" ╚══╝╚══╝ ",
         U"          ",
-      }
-    },
-    {
-      'X',
-      7,
-      8,
-      {
+        /* 'X' */
         U"██╗  ██╗",
         U"╚██╗██╔╝",
         U" ╚███╔╝ ",
@@ -1947,13 +2434,7 @@ const std::vector < Font > fonts = {
         U"██╔╝ ██╗",
         U"╚═╝  ╚═╝",
         U"        ",
-      }
-    },
-    {
-      'Y',
-      7,
-      9,
-      {
+        /* 'Y' */
         U"██╗   ██╗",
         U"╚██╗ ██╔╝",
         U" ╚████╔╝ ",
@@ -1961,13 +2442,7 @@ const std::vector < Font > fonts = {
         U"   ██║   ",
         U"   ╚═╝   ",
         U"         ",
-      }
-    },
-    {
-      'Z',
-      7,
-      8,
-      {
+        /* 'Z' */
         U"███████╗",
         U"╚══███╔╝",
         U"  ███╔╝ ",
@@ -1975,13 +2450,7 @@ const std::vector < Font > fonts = {
         U"███████╗",
         U"╚══════╝",
         U"        ",
-      }
-    },
-    {
-      '1',
-      7,
-      4,
-      {
+        /* '1' */
         U" ██╗",
         U"███║",
         U"╚██║",
@@ -1989,13 +2458,7 @@ const std::vector < Font > fonts = {
         U" ██║",
         U" ╚═╝",
         U"    ",
-      }
-    },
-    {
-      '2',
-      7,
-      8,
-      {
+        /* '2' */
         U"██████╗ ",
         U"╚════██╗",
         U" █████╔╝",
@@ -2003,13 +2466,7 @@ const std::vector < Font > fonts = {
         U"███████╗",
         U"╚══════╝",
         U"        ",
-      }
-    },
-    {
-      '3',
-      7,
-      8,
-      {
+        /* '3' */
         U"██████╗ ",
         U"╚════██╗",
         U" █████╔╝",
@@ -2017,13 +2474,7 @@ const std::vector < Font > fonts = {
         U"██████╔╝",
         U"╚═════╝ ",
         U"        ",
-      }
-    },
-    {
-      '4',
-      7,
-      8,
-      {
+        /* '4' */
         U"██╗  ██╗",
         U"██║  ██║",
         U"███████║",
@@ -2031,13 +2482,7 @@ const std::vector < Font > fonts = {
         U"     ██║",
         U"     ╚═╝",
         U"        ",
-      }
-    },
-    {
-      '5',
-      7,
-      8,
-      {
+        /* '5' */
         U"███████╗",
         U"██╔════╝",
         U"███████╗",
@@ -2045,13 +2490,7 @@ const std::vector < Font > fonts = {
         U"███████║",
         U"╚══════╝",
         U"        ",
-      }
-    },
-    {
-      '6',
-      7,
-      9,
-      {
+        /* '6' */
         U" ██████╗ ",
         U"██╔════╝ ",
         U"███████╗ ",
@@ -2059,13 +2498,7 @@ const std::vector < Font > fonts = {
         U"╚██████╔╝",
         U" ╚═════╝ ",
         U"         ",
-      }
-    },
-    {
-      '7',
-      7,
-      8,
-      {
+        /* '7' */
         U"███████╗",
         U"╚════██║",
         U"    ██╔╝",
@@ -2073,13 +2506,7 @@ const std::vector < Font > fonts = {
         U"   ██║  ",
         U"   ╚═╝  ",
         U"        ",
-      }
-    },
-    {
-      '8',
-      7,
-      8,
-      {
+        /* '8' */
         U" █████╗ ",
         U"██╔══██╗",
         U"╚█████╔╝",
@@ -2087,13 +2514,7 @@ const std::vector < Font > fonts = {
         U"╚█████╔╝",
         U" ╚════╝ ",
         U"        ",
-      }
-    },
-    {
-      '9',
-      7,
-      8,
-      {
+        /* '9' */
         U" █████╗ ",
         U"██╔══██╗",
         U"╚██████║",
@@ -2101,13 +2522,7 @@ const std::vector < Font > fonts = {
         U" █████╔╝",
         U" ╚════╝ ",
         U"        ",
-      }
-    },
-    {
-      '0',
-      7,
-      9,
-      {
+        /* '0' */
         U" ██████╗ ",
         U"██╔═████╗",
         U"██║██╔██║",
@@ -2115,13 +2530,7 @@ const std::vector < Font > fonts = {
         U"╚██████╔╝",
         U" ╚═════╝ ",
         U"         ",
-      }
-    },
-    {
-      '!',
-      7,
-      3,
-      {
+        /* '!' */
         U"██╗",
         U"██║",
         U"██║",
@@ -2129,13 +2538,7 @@ const std::vector < Font > fonts = {
         U"██╗",
         U"╚═╝",
         U"   ",
-      }
-    },
-    {
-      '@',
-      7,
-      9,
-      {
+        /* '@' */
         U" ██████╗ ",
         U"██╔═══██╗",
         U"██║██╗██║",
@@ -2143,13 +2546,7 @@ const std::vector < Font > fonts = {
         U"╚█║████╔╝",
         U" ╚╝╚═══╝ ",
         U"         ",
-      }
-    },
-    {
-      '#',
-      7,
-      9,
-      {
+        /* '#' */
         U" ██╗ ██╗ ",
         U"████████╗",
         U"╚██╔═██╔╝",
@@ -2157,13 +2554,7 @@ const std::vector < Font > fonts = {
         U"╚██╔═██╔╝",
         U" ╚═╝ ╚═╝ ",
         U"         ",
-      }
-    },
-    {
-      '$',
-      7,
-      8,
-      {
+        /* '$' */
         U"▄▄███▄▄·",
         U"██╔════╝",
         U"███████╗",
@@ -2171,13 +2562,7 @@ const std::vector < Font > fonts = {
         U"███████║",
         U"╚═▀▀▀══╝",
         U"        ",
-      }
-    },
-    {
-      '%',
-      7,
-      7,
-      {
+        /* '%' */
         U"██╗ ██╗",
         U"╚═╝██╔╝",
         U"  ██╔╝ ",
@@ -2185,13 +2570,7 @@ const std::vector < Font > fonts = {
         U"██╔╝██╗",
         U"╚═╝ ╚═╝",
         U"       ",
-      }
-    },
-    {
-      '^',
-      7,
-      6,
-      {
+        /* '^' */
         U" ███╗ ",
         U"██╔██╗",
         U"╚═╝╚═╝",
@@ -2199,13 +2578,7 @@ const std::vector < Font > fonts = {
         U"      ",
         U"      ",
         U"      ",
-      }
-    },
-    {
-      '&',
-      7,
-      9,
-      {
+        /* '&' */
         U"   ██╗   ",
         U"   ██║   ",
         U"████████╗",
@@ -2213,13 +2586,7 @@ const std::vector < Font > fonts = {
         U"██████║  ",
         U"╚═════╝  ",
         U"         ",
-      }
-    },
-    {
-      '*',
-      7,
-      6,
-      {
+        /* '*' */
         U"      ",
         U"▄ ██╗▄",
         U" ████╗",
@@ -2227,13 +2594,7 @@ const std::vector < Font > fonts = {
         U"  ╚═╝ ",
         U"      ",
         U"      ",
-      }
-    },
-    {
-      '(',
-      7,
-      4,
-      {
+        /* '(' */
         U" ██╗",
         U"██╔╝",
         U"██║ ",
@@ -2241,13 +2602,7 @@ const std::vector < Font > fonts = {
         U"╚██╗",
         U" ╚═╝",
         U"    ",
-      }
-    },
-    {
-      ')',
-      7,
-      4,
-      {
+        /* ')' */
         U"██╗ ",
         U"╚██╗",
         U" ██║",
@@ -2255,13 +2610,7 @@ const std::vector < Font > fonts = {
         U"██╔╝",
         U"╚═╝ ",
         U"    ",
-      }
-    },
-    {
-      '[',
-      7,
-      4,
-      {
+        /* '[' */
         U"███╗",
         U"██╔╝",
         U"██║ ",
@@ -2269,13 +2618,7 @@ const std::vector < Font > fonts = {
         U"███╗",
         U"╚══╝",
         U"    ",
-      }
-    },
-    {
-      ']',
-      7,
-      4,
-      {
+        /* ']' */
         U"███╗",
         U"╚██║",
         U" ██║",
@@ -2283,13 +2626,7 @@ const std::vector < Font > fonts = {
         U"███║",
         U"╚══╝",
         U"    ",
-      }
-    },
-    {
-      '?',
-      7,
-      8,
-      {
+        /* '?' */
         U"██████╗ ",
         U"╚════██╗",
         U"  ▄███╔╝",
@@ -2297,13 +2634,7 @@ const std::vector < Font > fonts = {
         U"  ██╗   ",
         U"  ╚═╝   ",
         U"        ",
-      }
-    },
-    {
-      '>',
-      7,
-      5,
-      {
+        /* '>' */
         U"██╗  ",
         U"╚██╗ ",
         U" ╚██╗",
@@ -2311,13 +2642,7 @@ const std::vector < Font > fonts = {
         U"██╔╝ ",
         U"╚═╝  ",
         U"     ",
-      }
-    },
-    {
-      '<',
-      7,
-      5,
-      {
+        /* '<' */
         U"  ██╗",
         U" ██╔╝",
         U"██╔╝ ",
@@ -2325,15 +2650,64 @@ const std::vector < Font > fonts = {
         U" ╚██╗",
         U"  ╚═╝",
         U"     ",
-      }
-    }
-  }),
-  Font({
-    {
-      'A',
-      7,
-      12,
-      {
+    };
+
+    constexpr Character AnsiShadow[] = {
+        Character('A', 7, 8, AnsiShadowRows + 0, 7),
+        Character('B', 7, 8, AnsiShadowRows + 7, 7),
+        Character('C', 7, 8, AnsiShadowRows + 14, 7),
+        Character('D', 7, 8, AnsiShadowRows + 21, 7),
+        Character('E', 7, 8, AnsiShadowRows + 28, 7),
+        Character('F', 7, 8, AnsiShadowRows + 35, 7),
+        Character('G', 7, 9, AnsiShadowRows + 42, 7),
+        Character('H', 7, 8, AnsiShadowRows + 49, 7),
+        Character('I', 7, 3, AnsiShadowRows + 56, 7),
+        Character('J', 7, 8, AnsiShadowRows + 63, 7),
+        Character('K', 7, 8, AnsiShadowRows + 70, 7),
+        Character('L', 7, 8, AnsiShadowRows + 77, 7),
+        Character('M', 7, 11, AnsiShadowRows + 84, 7),
+        Character('N', 7, 10, AnsiShadowRows + 91, 7),
+        Character('O', 7, 9, AnsiShadowRows + 98, 7),
+        Character('P', 7, 8, AnsiShadowRows + 105, 7),
+        Character('Q', 7, 9, AnsiShadowRows + 112, 7),
+        Character('R', 7, 8, AnsiShadowRows + 119, 7),
+        Character('S', 7, 8, AnsiShadowRows + 126, 7),
+        Character('T', 7, 9, AnsiShadowRows + 133, 7),
+        Character('U', 7, 9, AnsiShadowRows + 140, 7),
+        Character('V', 7, 9, AnsiShadowRows + 147, 7),
+        Character('W', 7, 10, AnsiShadowRows + 154, 7),
+        Character('X', 7, 8, AnsiShadowRows + 161, 7),
+        Character('Y', 7, 9, AnsiShadowRows + 168, 7),
+        Character('Z', 7, 8, AnsiShadowRows + 175, 7),
+        Character('1', 7, 4, AnsiShadowRows + 182, 7),
+        Character('2', 7, 8, AnsiShadowRows + 189, 7),
+        Character('3', 7, 8, AnsiShadowRows + 196, 7),
+        Character('4', 7, 8, AnsiShadowRows + 203, 7),
+        Character('5', 7, 8, AnsiShadowRows + 210, 7),
+        Character('6', 7, 9, AnsiShadowRows + 217, 7),
+        Character('7', 7, 8, AnsiShadowRows + 224, 7),
+        Character('8', 7, 8, AnsiShadowRows + 231, 7),
+        Character('9', 7, 8, AnsiShadowRows + 238, 7),
+        Character('0', 7, 9, AnsiShadowRows + 245, 7),
+        Character('!', 7, 3, AnsiShadowRows + 252, 7),
+        Character('@', 7, 9, AnsiShadowRows + 259, 7),
+        Character('#', 7, 9, AnsiShadowRows + 266, 7),
+        Character('$', 7, 8, AnsiShadowRows + 273, 7),
+        Character('%', 7, 7, AnsiShadowRows + 280, 7),
+        Character('^', 7, 6, AnsiShadowRows + 287, 7),
+        Character('&', 7, 9, AnsiShadowRows + 294, 7),
+        Character('*', 7, 6, AnsiShadowRows + 301, 7),
+        Character('(', 7, 4, AnsiShadowRows + 308, 7),
+        Character(')', 7, 4, AnsiShadowRows + 315, 7),
+        Character('[', 7, 4, AnsiShadowRows + 322, 7),
+        Character(']', 7, 4, AnsiShadowRows + 329, 7),
+        Character('?', 7, 8, AnsiShadowRows + 336, 7),
+        Character('>', 7, 5, AnsiShadowRows + 343, 7),
+        Character('<', 7, 5, AnsiShadowRows + 350, 7),
+    };
+
+    constexpr glyphRow Aligator2Rows[] = {
+        /* 'A' */
         U"    :::     ",
         U"  :+: :+:   ",
         U" +:+   +:+  ",
@@ -2341,13 +2715,7 @@ const std::vector < Font > fonts = {
         U"+#+     +#+ ",
         U"#+#     #+# ",
         U"###     ### ",
-      }
-    },
-    {
-      'B',
-      7,
-      11,
-      {
+        /* 'B' */
         U":::::::::  ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2355,13 +2723,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U"#########  ",
-      }
-    },
-    {
-      'C',
-      7,
-      11,
-      {
+        /* 'C' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"+:+        ",
@@ -2369,13 +2731,7 @@ const std::vector < Font > fonts = {
         U"+#+        ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      'D',
-      7,
-      11,
-      {
+        /* 'D' */
         U":::::::::  ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2383,13 +2739,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U"#########  ",
-      }
-    },
-    {
-      'E',
-      7,
-      11,
-      {
+        /* 'E' */
         U":::::::::: ",
         U":+:        ",
         U"+:+        ",
@@ -2397,13 +2747,7 @@ const std::vector < Font > fonts = {
         U"+#+        ",
         U"#+#        ",
         U"########## ",
-      }
-    },
-    {
-      'F',
-      7,
-      10,
-      {
+        /* 'F' */
         U"::::::::::",
         U":+:       ",
         U"+:+       ",
@@ -2411,13 +2755,7 @@ const std::vector < Font > fonts = {
         U"+#+       ",
         U"#+#       ",
         U"###       ",
-      }
-    },
-    {
-      'G',
-      7,
-      11,
-      {
+        /* 'G' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"+:+        ",
@@ -2425,13 +2763,7 @@ const std::vector < Font > fonts = {
         U"+#+   +#+# ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      'H',
-      7,
-      11,
-      {
+        /* 'H' */
         U":::    ::: ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2439,13 +2771,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U"###    ### ",
-      }
-    },
-    {
-      'I',
-      7,
-      12,
-      {
+        /* 'I' */
         U"::::::::::: ",
         U"    :+:     ",
         U"    +:+     ",
@@ -2453,13 +2779,7 @@ const std::vector < Font > fonts = {
         U"    +#+     ",
         U"    #+#     ",
         U"########### ",
-      }
-    },
-    {
-      'J',
-      7,
-      12,
-      {
+        /* 'J' */
         U"::::::::::: ",
         U"    :+:     ",
         U"    +:+     ",
@@ -2467,13 +2787,7 @@ const std::vector < Font > fonts = {
         U"    +#+     ",
         U"#+# #+#     ",
         U" #####      ",
-      }
-    },
-    {
-      'K',
-      7,
-      11,
-      {
+        /* 'K' */
         U":::    ::: ",
         U":+:   :+:  ",
         U"+:+  +:+   ",
@@ -2481,13 +2795,7 @@ const std::vector < Font > fonts = {
         U"+#+  +#+   ",
         U"#+#   #+#  ",
         U"###    ### ",
-      }
-    },
-    {
-      'L',
-      7,
-      11,
-      {
+        /* 'L' */
         U":::        ",
         U":+:        ",
         U"+:+        ",
@@ -2495,13 +2803,7 @@ const std::vector < Font > fonts = {
         U"+#+        ",
         U"#+#        ",
         U"########## ",
-      }
-    },
-    {
-      'M',
-      7,
-      14,
-      {
+        /* 'M' */
         U"::::    ::::  ",
         U"+:+:+: :+:+:+ ",
         U"+:+ +:+:+ +:+ ",
@@ -2509,13 +2811,7 @@ const std::vector < Font > fonts = {
         U"+#+       +#+ ",
         U"#+#       #+# ",
         U"###       ### ",
-      }
-    },
-    {
-      'N',
-      7,
-      12,
-      {
+        /* 'N' */
         U"::::    ::: ",
         U":+:+:   :+: ",
         U":+:+:+  +:+ ",
@@ -2523,13 +2819,7 @@ const std::vector < Font > fonts = {
         U"+#+  +#+#+# ",
         U"#+#   #+#+# ",
         U"###    #### ",
-      }
-    },
-    {
-      'O',
-      7,
-      11,
-      {
+        /* 'O' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2537,13 +2827,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      'P',
-      7,
-      11,
-      {
+        /* 'P' */
         U":::::::::  ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2551,13 +2835,7 @@ const std::vector < Font > fonts = {
         U"+#+        ",
         U"#+#        ",
         U"###        ",
-      }
-    },
-    {
-      'Q',
-      7,
-      12,
-      {
+        /* 'Q' */
         U" ::::::::   ",
         U":+:    :+:  ",
         U"+:+    +:+  ",
@@ -2565,13 +2843,7 @@ const std::vector < Font > fonts = {
         U"+#+  # +#+  ",
         U"#+#   +#+   ",
         U" ###### ### ",
-      }
-    },
-    {
-      'R',
-      7,
-      11,
-      {
+        /* 'R' */
         U":::::::::  ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2579,13 +2851,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U"###    ### ",
-      }
-    },
-    {
-      'S',
-      7,
-      10,
-      {
+        /* 'S' */
         U" :::::::: ",
         U":+:    :+:",
         U"+:+       ",
@@ -2593,13 +2859,7 @@ const std::vector < Font > fonts = {
         U"       +#+",
         U"#+#    #+#",
         U" ######## ",
-      }
-    },
-    {
-      'T',
-      7,
-      12,
-      {
+        /* 'T' */
         U"::::::::::: ",
         U"    :+:     ",
         U"    +:+     ",
@@ -2607,13 +2867,7 @@ const std::vector < Font > fonts = {
         U"    +#+     ",
         U"    #+#     ",
         U"    ###     ",
-      }
-    },
-    {
-      'U',
-      7,
-      11,
-      {
+        /* 'U' */
         U":::    ::: ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2621,13 +2875,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      'V',
-      7,
-      12,
-      {
+        /* 'V' */
         U":::     ::: ",
         U":+:     :+: ",
         U"+:+     +:+ ",
@@ -2635,13 +2883,7 @@ const std::vector < Font > fonts = {
         U" +#+   +#+  ",
         U"  #+#+#+#   ",
         U"    ###     ",
-      }
-    },
-    {
-      'W',
-      7,
-      14,
-      {
+        /* 'W' */
         U":::       ::: ",
         U":+:       :+: ",
         U"+:+       +:+ ",
@@ -2649,13 +2891,7 @@ const std::vector < Font > fonts = {
         U"+#+ +#+#+ +#+ ",
         U" #+#+# #+#+#  ",
         U"  ###   ###   ",
-      }
-    },
-    {
-      'X',
-      7,
-      11,
-      {
+        /* 'X' */
         U":::    ::: ",
         U":+:    :+: ",
         U" +:+  +:+  ",
@@ -2663,13 +2899,7 @@ const std::vector < Font > fonts = {
         U" +#+  +#+  ",
         U"#+#    #+# ",
         U"###    ### ",
-      }
-    },
-    {
-      'Y',
-      7,
-      10,
-      {
+        /* 'Y' */
         U":::   ::: ",
         U":+:   :+: ",
         U" +:+ +:+  ",
@@ -2677,13 +2907,7 @@ const std::vector < Font > fonts = {
         U"   +#+    ",
         U"   #+#    ",
         U"   ###    ",
-      }
-    },
-    {
-      'Z',
-      7,
-      10,
-      {
+        /* 'Z' */
         U"::::::::: ",
         U"     :+:  ",
         U"    +:+   ",
@@ -2691,13 +2915,7 @@ const std::vector < Font > fonts = {
         U"  +#+     ",
         U" #+#      ",
         U"######### ",
-      }
-    },
-    {
-      '1',
-      7,
-      8,
-      {
+        /* '1' */
         U"  :::   ",
         U":+:+:   ",
         U"  +:+   ",
@@ -2705,13 +2923,7 @@ const std::vector < Font > fonts = {
         U"  +#+   ",
         U"  #+#   ",
         U"####### ",
-      }
-    },
-    {
-      '2',
-      7,
-      11,
-      {
+        /* '2' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"      +:+  ",
@@ -2719,13 +2931,7 @@ const std::vector < Font > fonts = {
         U"  +#+      ",
         U" #+#       ",
         U"########## ",
-      }
-    },
-    {
-      '3',
-      7,
-      11,
-      {
+        /* '3' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"       +:+ ",
@@ -2733,13 +2939,7 @@ const std::vector < Font > fonts = {
         U"       +#+ ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      '4',
-      7,
-      11,
-      {
+        /* '4' */
         U"    :::    ",
         U"   :+:     ",
         U"  +:+ +:+  ",
@@ -2747,13 +2947,7 @@ const std::vector < Font > fonts = {
         U"+#+#+#+#+#+",
         U"      #+#  ",
         U"      ###  ",
-      }
-    },
-    {
-      '5',
-      7,
-      11,
-      {
+        /* '5' */
         U":::::::::: ",
         U":+:    :+: ",
         U"+:+        ",
@@ -2761,13 +2955,7 @@ const std::vector < Font > fonts = {
         U"       +#+ ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      '6',
-      7,
-      11,
-      {
+        /* '6' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"+:+        ",
@@ -2775,13 +2963,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      '7',
-      7,
-      12,
-      {
+        /* '7' */
         U"::::::::::: ",
         U":+:     :+: ",
         U"       +:+  ",
@@ -2789,13 +2971,7 @@ const std::vector < Font > fonts = {
         U"     +#+    ",
         U"    #+#     ",
         U"    ###     ",
-      }
-    },
-    {
-      '8',
-      7,
-      11,
-      {
+        /* '8' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2803,13 +2979,7 @@ const std::vector < Font > fonts = {
         U"+#+    +#+ ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      '9',
-      7,
-      11,
-      {
+        /* '9' */
         U" ::::::::  ",
         U":+:    :+: ",
         U"+:+    +:+ ",
@@ -2817,13 +2987,7 @@ const std::vector < Font > fonts = {
         U"       +#+ ",
         U"#+#    #+# ",
         U" ########  ",
-      }
-    },
-    {
-      '0',
-      7,
-      10,
-      {
+        /* '0' */
         U" :::::::  ",
         U":+:   :+: ",
         U"+:+  :+:+ ",
@@ -2831,13 +2995,7 @@ const std::vector < Font > fonts = {
         U"+#+#  +#+ ",
         U"#+#   #+# ",
         U" #######  ",
-      }
-    },
-    {
-      '!',
-      7,
-      4,
-      {
+        /* '!' */
         U"::: ",
         U":+: ",
         U"+:+ ",
@@ -2845,13 +3003,7 @@ const std::vector < Font > fonts = {
         U"+#+ ",
         U"    ",
         U"### ",
-      }
-    },
-    {
-      '@',
-      7,
-      18,
-      {
+        /* '@' */
         U"   :::::::::::    ",
         U" :+: :+:+:+:+:+:  ",
         U"+:+ +:+   +:+ +:+ ",
@@ -2859,13 +3011,7 @@ const std::vector < Font > fonts = {
         U"+#+ +#+   +#+ +#+ ",
         U" #+# #+#+#+#+#+   ",
         U"   #####          ",
-      }
-    },
-    {
-      '#',
-      7,
-      16,
-      {
+        /* '#' */
         U"   :::   :::    ",
         U"   :+:   :+:    ",
         U"+:+:+:+:+:+:+:+ ",
@@ -2873,13 +3019,7 @@ const std::vector < Font > fonts = {
         U"+#+#+#+#+#+#+#+ ",
         U"   #+#   #+#    ",
         U"   ###   ###    ",
-      }
-    },
-    {
-      '$',
-      7,
-      12,
-      {
+        /* '$' */
         U"     :::    ",
         U"  :+:+:+:+: ",
         U"+:+  +:+    ",
@@ -2887,13 +3027,7 @@ const std::vector < Font > fonts = {
         U"     +#+ +#+",
         U"  #+#+#+#+# ",
         U"     ###    ",
-      }
-    },
-    {
-      '%',
-      7,
-      15,
-      {
+        /* '%' */
         U":::   :::      ",
         U":+:   :+:      ",
         U"      +:+      ",
@@ -2901,13 +3035,7 @@ const std::vector < Font > fonts = {
         U"      +#+      ",
         U"      #+#   #+#",
         U"      ###   ###",
-      }
-    },
-    {
-      '^',
-      7,
-      11,
-      {
+        /* '^' */
         U"    :::    ",
         U"  :+: :+:  ",
         U"+:+     +:+",
@@ -2915,13 +3043,7 @@ const std::vector < Font > fonts = {
         U"           ",
         U"           ",
         U"           ",
-      }
-    },
-    {
-      '&',
-      7,
-      13,
-      {
+        /* '&' */
         U" :::::::     ",
         U":+:   :+:    ",
         U" +:+ +:+     ",
@@ -2929,13 +3051,7 @@ const std::vector < Font > fonts = {
         U" +#+ +#+#+#  ",
         U"#+#   #+#+   ",
         U" ##########  ",
-      }
-    },
-    {
-      '*',
-      7,
-      14,
-      {
+        /* '*' */
         U"              ",
         U" :+:     :+:  ",
         U"   +:+ +:+    ",
@@ -2943,13 +3059,7 @@ const std::vector < Font > fonts = {
         U"   +#+ +#+    ",
         U" #+#     #+#  ",
         U"              ",
-      }
-    },
-    {
-      '(',
-      7,
-      6,
-      {
+        /* '(' */
         U"  ::: ",
         U" :+:  ",
         U"+:+   ",
@@ -2957,13 +3067,7 @@ const std::vector < Font > fonts = {
         U"+#+   ",
         U" #+#  ",
         U"  ### ",
-      }
-    },
-    {
-      ')',
-      7,
-      6,
-      {
+        /* ')' */
         U":::   ",
         U" :+:  ",
         U"  +:+ ",
@@ -2971,13 +3075,7 @@ const std::vector < Font > fonts = {
         U"  +#+ ",
         U" #+#  ",
         U"###   ",
-      }
-    },
-    {
-      '[',
-      7,
-      7,
-      {
+        /* '[' */
         U":::::: ",
         U":+:    ",
         U"+:+    ",
@@ -2985,13 +3083,7 @@ const std::vector < Font > fonts = {
         U"+#+    ",
         U"#+#    ",
         U"###### ",
-      }
-    },
-    {
-      ']',
-      7,
-      7,
-      {
+        /* ']' */
         U":::::: ",
         U"   :+: ",
         U"   +:+ ",
@@ -2999,13 +3091,7 @@ const std::vector < Font > fonts = {
         U"   +#+ ",
         U"   #+# ",
         U"###### ",
-      }
-    },
-    {
-      '?',
-      7,
-      11,
-      {
+        /* '?' */
         U" ::::::::: ",
         U":+:     :+:",
         U"       +:+ ",
@@ -3013,13 +3099,7 @@ const std::vector < Font > fonts = {
         U"    +#+    ",
         U"           ",
         U"    ###   #",
-      }
-    },
-    {
-      '>',
-      7,
-      7,
-      {
+        /* '>' */
         U":::    ",
         U" :+:   ",
         U"  +:+  ",
@@ -3027,13 +3107,7 @@ const std::vector < Font > fonts = {
         U"  +#+  ",
         U" #+#   ",
         U"##     ",
-      }
-    },
-    {
-      '<',
-      7,
-      7,
-      {
+        /* '<' */
         U"   ::: ",
         U"  :+:  ",
         U" +:+   ",
@@ -3041,10 +3115,72 @@ const std::vector < Font > fonts = {
         U" +#+   ",
         U"  #+#  ",
         U"   ### ",
-      }
-    }
-  })
-};
+    };
+
+    constexpr Character Aligator2[] = {
+        Character('A', 7, 12, Aligator2Rows + 0, 7),
+        Character('B', 7, 11, Aligator2Rows + 7, 7),
+        Character('C', 7, 11, Aligator2Rows + 14, 7),
+        Character('D', 7, 11, Aligator2Rows + 21, 7),
+        Character('E', 7, 11, Aligator2Rows + 28, 7),
+        Character('F', 7, 10, Aligator2Rows + 35, 7),
+        Character('G', 7, 11, Aligator2Rows + 42, 7),
+        Character('H', 7, 11, Aligator2Rows + 49, 7),
+        Character('I', 7, 12, Aligator2Rows + 56, 7),
+        Character('J', 7, 12, Aligator2Rows + 63, 7),
+        Character('K', 7, 11, Aligator2Rows + 70, 7),
+        Character('L', 7, 11, Aligator2Rows + 77, 7),
+        Character('M', 7, 14, Aligator2Rows + 84, 7),
+        Character('N', 7, 12, Aligator2Rows + 91, 7),
+        Character('O', 7, 11, Aligator2Rows + 98, 7),
+        Character('P', 7, 11, Aligator2Rows + 105, 7),
+        Character('Q', 7, 12, Aligator2Rows + 112, 7),
+        Character('R', 7, 11, Aligator2Rows + 119, 7),
+        Character('S', 7, 10, Aligator2Rows + 126, 7),
+        Character('T', 7, 12, Aligator2Rows + 133, 7),
+        Character('U', 7, 11, Aligator2Rows + 140, 7),
+        Character('V', 7, 12, Aligator2Rows + 147, 7),
+        Character('W', 7, 14, Aligator2Rows + 154, 7),
+        Character('X', 7, 11, Aligator2Rows + 161, 7),
+        Character('Y', 7, 10, Aligator2Rows + 168, 7),
+        Character('Z', 7, 10, Aligator2Rows + 175, 7),
+        Character('1', 7, 8, Aligator2Rows + 182, 7),
+        Character('2', 7, 11, Aligator2Rows + 189, 7),
+        Character('3', 7, 11, Aligator2Rows + 196, 7),
+        Character('4', 7, 11, Aligator2Rows + 203, 7),
+        Character('5', 7, 11, Aligator2Rows + 210, 7),
+        Character('6', 7, 11, Aligator2Rows + 217, 7),
+        Character('7', 7, 12, Aligator2Rows + 224, 7),
+        Character('8', 7, 11, Aligator2Rows + 231, 7),
+        Character('9', 7, 11, Aligator2Rows + 238, 7),
+        Character('0', 7, 10, Aligator2Rows + 245, 7),
+        Character('!', 7, 4, Aligator2Rows + 252, 7),
+        Character('@', 7, 18, Aligator2Rows + 259, 7),
+        Character('#', 7, 16, Aligator2Rows + 266, 7),
+        Character('$', 7, 12, Aligator2Rows + 273, 7),
+        Character('%', 7, 15, Aligator2Rows + 280, 7),
+        Character('^', 7, 11, Aligator2Rows + 287, 7),
+        Character('&', 7, 13, Aligator2Rows + 294, 7),
+        Character('*', 7, 14, Aligator2Rows + 301, 7),
+        Character('(', 7, 6, Aligator2Rows + 308, 7),
+        Character(')', 7, 6, Aligator2Rows + 315, 7),
+        Character('[', 7, 7, Aligator2Rows + 322, 7),
+        Character(']', 7, 7, Aligator2Rows + 329, 7),
+        Character('?', 7, 11, Aligator2Rows + 336, 7),
+        Character('>', 7, 7, Aligator2Rows + 343, 7),
+        Character('<', 7, 7, Aligator2Rows + 350, 7),
+    };
+}
+
+/*
+ * fonts - the built-in fonts, indexed by AvailableFonts::EnumFonts.
+ */
+const std::array<Font, 4> fonts = {{
+    Font(builtinFontData::Mono12),
+    Font(builtinFontData::Bloody),
+    Font(builtinFontData::AnsiShadow),
+    Font(builtinFontData::Aligator2)
+}};
 
 /* --------------------------------------------------------------------------
    coords - simple integer 2D coordinate
@@ -3054,6 +3190,105 @@ struct coords {
     int y;
 };
 
+/* --------------------------------------------------------------------------
+   titleLayout - cached placement of a big-font string
+   -------------------------------------------------------------------------- */
+/*
+ * titleLayout
+ *
+ * The glyphs of a string in a Font, their x offsets from the left edge and
+ * the bounding box around a centre column. update() re-measures only when
+ * the text or font changed and re-centres only when the column changed, so
+ * an unchanged title costs one string compare per frame.
+ *
+ * Fonts are compared by address; call invalidate() after modifying a Font
+ * in place.
+ */
+class titleLayout {
+public:
+    struct placedGlyph {
+        const Character* glyph;
+        int offset;             /* columns from left() */
+    };
+
+    titleLayout()
+        : font_(nullptr), center_(0), width_(0), height_(0), rows_(0),
+          left_(0), right_(0), generation_(0), valid_(false) {}
+
+    /* Lay out text in font centred on column center; true if anything changed */
+    bool update(const std::string & text, const Font* font, int center) {
+        if (valid_ && center == center_ && font == font_ && text == text_) return false;
+
+        if (!valid_ || font != font_ || text != text_) {
+            text_ = text;
+            font_ = font;
+            measure();
+        }
+
+        center_ = center;
+        left_ = center - width_ / 2;
+        right_ = center + width_ / 2;
+        generation_ = nextGeneration();
+        valid_ = true;
+        return true;
+    }
+
+    void invalidate() noexcept { valid_ = false; }
+
+    const std::vector<placedGlyph> & glyphs() const noexcept { return glyphs_; }
+    const Font* font() const noexcept { return font_; }
+
+    /* Total glyph width and tallest declared glyph height */
+    int width() const noexcept  { return width_; }
+    int height() const noexcept { return height_; }
+
+    /* Rows the glyphs actually cover; some glyphs have more rows than their height */
+    int rows() const noexcept { return rows_; }
+
+    /* Bounding columns around the centre (right = center + width / 2) */
+    int left() const noexcept  { return left_; }
+    int right() const noexcept { return right_; }
+
+    /* Changes whenever update() changes anything; unique across all layouts */
+    unsigned long long generation() const noexcept { return generation_; }
+
+private:
+    static unsigned long long nextGeneration() {
+        static unsigned long long counter = 0;
+        return ++counter;
+    }
+
+    void measure() {
+        glyphs_.clear();
+        width_ = 0;
+        height_ = 0;
+        rows_ = 0;
+        if (font_ == nullptr) return;
+
+        for (char c : text_) {
+            const Character* pch = (*font_)[c];
+            if (pch == nullptr) continue;
+
+            glyphs_.push_back(placedGlyph{ pch, width_ });
+            width_ += pch->dataWidth;
+            height_ = std::max(height_, pch->height);
+            rows_ = std::max({ rows_, pch->height, pch->dataHeight });
+        }
+    }
+
+    std::string text_;
+    const Font* font_;
+    int center_;
+    std::vector<placedGlyph> glyphs_;
+    int width_;
+    int height_;
+    int rows_;
+    int left_;
+    int right_;
+    unsigned long long generation_;
+    bool valid_;
+};
+
 /* --------------------------------------------------------------------------
    UI_Option - a selectable option with callbacks
    -------------------------------------------------------------------------- */
@@ -3087,12 +3322,40 @@ public:
             if (f) f();
     }
 
+    /*
+     * SubscribeAsync(work, done)
+     *
+     * work runs on cliMenu's worker threads instead of inside the input
+     * loop, so a slow action (a network check, say) does not freeze the
+     * menu; a busy indicator spins and navigation keeps working meanwhile.
+     * done, if given, runs back on the loop's thread after work returned -
+     * the place to put the outcome into the menu. work must not draw or
+     * touch the menu. Subscribe() stays synchronous.
+     */
+    void SubscribeAsync(void(*work)(), void(*done)() = nullptr) {
+        asyncFunctions.push_back({ work, done });
+    }
+
+    void UnsubscribeAsync(void(*work)()) {
+        auto it = std::find_if(asyncFunctions.begin(), asyncFunctions.end(),
+                               [work](const asyncCallback& a) { return a.work == work; });
+        if (it != asyncFunctions.end())
+            asyncFunctions.erase(it);
+    }
+
     /* Display text */
     std::string text;
 
     /* Callback list */
     std::vector<void(*)()> functions;
 
+    /* Callbacks for the worker threads, each with its completion */
+    struct asyncCallback {
+        void(*work)();
+        void(*done)();
+    };
+    std::vector<asyncCallback> asyncFunctions;
+
     /* Optional override color (kept name/behavior) */
     bool overwriteColor_huh;
     c_pixel overwiteColor;
@@ -3123,6 +3386,7 @@ struct UI_Option_Bar {
  * - barStyle: formatting tokens for option bar drawing
  * - titleFont: pointer into fonts[]
  * - colorFunction: optional function that returns c_pixel given normalized coords
+ * - colorSpan: optional batch form (see colorSpanFunction); used over colorFunction
  */
 class subMenu {
 public:
@@ -3134,7 +3398,8 @@ public:
           barColor{255,50,255},
           barStyle(UI_Option_Bar{"-------------------", "\t-", "", "", "\t    ==> " , false}),
           titleFont(nullptr),
-          colorFunction(nullptr)
+          colorFunction(nullptr),
+          revision(0)
     {
         /* default titleFont points to Mono12 if available */
         if (!fonts.empty()) titleFont = &fonts[AvailableFonts::Mono12];
@@ -3143,12 +3408,14 @@ public:
     /* Add a single option (by reference copy) */
     void addOption(const UI_Option & opt) {
         options.push_back(opt);
+        markChanged();
     }
 
     /* Add many options (copy) */
     void addOptions(const std::vector<UI_Option> & new_options) {
         for (const auto& opt : new_options)
             options.push_back(opt);
+        markChanged();
     }
 
     /* Setters for appearance */
@@ -3157,11 +3424,39 @@ public:
             titleFont = &(fonts[fontToUse]);
         else if (!fonts.empty())
             titleFont = &fonts[AvailableFonts::Mono12];
+        markChanged();
+    }
+
+    /* Use any Font, e.g. one from loadFigletFont(); it must outlive the subMenu */
+    void setFont(const Font* font) {
+        titleFont = font;
+        markChanged();
+    }
+
+    /*
+     * cliMenu caches the finished title cells only while colorFunction and
+     * colorSpan are plain functions (or empty), keyed on their addresses.
+     * A lambda or other callable object is evaluated again on every full
+     * frame, so callables with state or that depend on time keep working.
+     */
+    void setColorFunction(std::function<c_pixel(double, double)> fn) {
+        colorFunction = std::move(fn);
+        markChanged();
     }
 
-    void setSelectedColor(color c) { selectedColor = c; }
-    void setDefaultColor(color c) { defaultColor = c; }
-    void setBarColor(color c)     { barColor = c; }
+    void setColorSpanFunction(colorSpanFunction fn) {
+        colorSpan = std::move(fn);
+        markChanged();
+    }
+
+    /* The title coloring to apply: colorSpan, else colorFunction wrapped, else empty */
+    colorSpanFunction titleColoring() const {
+        return colorSpan ? colorSpan : spanOf(colorFunction);
+    }
+
+    void setSelectedColor(color c) { selectedColor = c; markChanged(); }
+    void setDefaultColor(color c) { defaultColor = c; markChanged(); }
+    void setBarColor(color c)     { barColor = c; markChanged(); }
 
     void setBarStyle(const std::string& top,
                      const std::string& beforeOption,
@@ -3171,12 +3466,20 @@ public:
                      bool hasGap = false)
     {
         barStyle = UI_Option_Bar{top, beforeOption, afterOption, gap, selected, hasGap};
+        markChanged();
     }
 
     void setBarStyle(const UI_Option_Bar & newBarStyle) {
         barStyle = newBarStyle;
+        markChanged();
     }
 
+    /*
+     * Tell cliMenu's retained mode that the layout must be rebuilt.
+     * The setters above do this; call it after writing the public members directly.
+     */
+    void markChanged() { ++revision; }
+
     void incrementOption() {
         if (options.empty()) return;
         ++selectedOption;
@@ -3212,389 +3515,1875 @@ public:
 
     const Font* titleFont;
     std::function<c_pixel(double, double)> colorFunction;
+    colorSpanFunction colorSpan;
+
+    /* Bumped by markChanged() */
+    unsigned int revision;
+
+    /* Title placement, refreshed by cliMenu when name, font or width change */
+    titleLayout title;
 };
 
 /* --------------------------------------------------------------------------
-   cliMenu - main interactive menu system
+   frameSink - collects a frame and writes it to a file descriptor at once
    -------------------------------------------------------------------------- */
 /*
- * cliMenu
+ * frameSink
  *
- * - Manages a character buffer, color buffer and prints to the console.
- * - Preserves original public API (init, addBorder, DrawMenu, startLoop, etc).
+ * Frames are appended to a reusable buffer (its capacity survives flushes)
+ * and flush() hands the whole thing to writeOut() in one call, which by
+ * default is a single write() to fd (looping only on partial writes).
+ * Derive and override writeOut() to send frames somewhere else.
  */
-class cliMenu {
+class frameSink {
 public:
-    cliMenu() : width(0), height(0), borderEnabled(false), currentMenu(0), exit(false) {
-        init();
-    }
+    explicit frameSink(int fd = 1 /* stdout */) : fd_(fd) {}
+    virtual ~frameSink() = default;
 
-    /* Print only changed cells (keeps original behavior) */
-    void printChanges() {
-        static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv;
-
-        for (int row = 0; row < height; ++row) {
-            for (int col = 0; col < width; ++col) {
-                if (!isChanged[row][col]) continue;
+    std::string& frame() noexcept { return frame_; }
 
-                cursor(col, row);
+    void append(const char* data, size_t size) { frame_.append(data, size); }
+    void append(const std::string& str) { frame_ += str; }
 
-                char32_t c = buffer[row][col];
-                color_buffer[row][col].setTextColor();
-                std::cout << conv.to_bytes(c);
+    void flush() {
+        if (!frame_.empty()) writeOut(frame_.data(), frame_.size());
+        frame_.clear();
+    }
 
-                isChanged[row][col] = false;
-            }
+    int fd() const noexcept { return fd_; }
+    void setFd(int fd) noexcept { fd_ = fd; }
+
+protected:
+    virtual void writeOut(const char* data, size_t size) {
+        /* Keep ordering with anything still sitting in the iostream buffers */
+        std::cout.flush();
+
+        while (size > 0) {
+            #ifdef _WIN32
+                int written = _write(fd_, data, static_cast<unsigned int>(size));
+                if (written <= 0) return;
+            #else
+                ssize_t written = ::write(fd_, data, size);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) return;
+            #endif
+            data += written;
+            size -= static_cast<size_t>(written);
         }
     }
 
-    /* Print full buffer optimized into a single string (original frame builder) */
-    void printBuffer() {
-        static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv;
+private:
+    std::string frame_;
+    int fd_;
+};
 
-        std::string frame;
-        frame.reserve(static_cast<size_t>(width) * static_cast<size_t>(height) * 8);
+/* --------------------------------------------------------------------------
+   Keyboard input - raw terminal mode and escape sequence decoding
+   -------------------------------------------------------------------------- */
+/*
+ * InputKeys::EnumKey
+ *
+ * Codes for keys that have no character of their own. They start above the
+ * Unicode range, so a key handler can tell them apart from plain bytes.
+ */
+namespace InputKeys {
+    enum EnumKey {
+        Up = 0x110000,
+        Down,
+        Left,
+        Right,
+        Home,
+        End,
+        Insert,
+        Delete,
+        PageUp,
+        PageDown,
+        F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+        Paste /* bracketed paste; the text travels in keyEvent::text */
+    };
+}
 
-        frame += ERASE_CONSOLE; /* clear screen */
-        frame += START_SEQUENCE "H"; /* cursor home */
+/* One decoded key: a byte, or an InputKeys code */
+struct keyEvent {
+    int key;
+    std::string text;
+};
 
-        for (int row = 0; row < height; ++row) {
-            for (int col = 0; col < width; ++col) {
-                const c_pixel & pix = color_buffer[row][col];
-                char32_t c = buffer[row][col];
+/*
+ * keyDecoder
+ *
+ * Turns the bytes sent by a VT/xterm-style terminal into keys. CSI and SS3
+ * escape sequences are looked up in a table (a modifier parameter such as
+ * the 5 in ESC[1;5A is ignored, unknown sequences are dropped), anything
+ * else is passed on byte by byte. A sequence may be split across feed()
+ * calls: pending() then reports it, and the caller flush()es it as plain
+ * bytes when nothing followed within ESCAPE_DELAY_MS - which is how a lone
+ * Esc press arrives. Text between ESC[200~ and ESC[201~ becomes a single
+ * InputKeys::Paste event.
+ */
+class keyDecoder {
+public:
+    enum : int { ESCAPE_DELAY_MS = 25 };
 
-                /* Foreground */
-                frame += ESC_COLOR_CODE;
-                frame += FOREGROUND_SEQUENCE
-                      + std::to_string(static_cast<int>(pix.foreground().r)) + SEQUENCE_ARG_SEPARATOR
-                      + std::to_string(static_cast<int>(pix.foreground().g)) + SEQUENCE_ARG_SEPARATOR
-                      + std::to_string(static_cast<int>(pix.foreground().b)) + CLOSE_SEQUENCE;
+    keyDecoder() : pasting_(false) {}
 
-                /* Background */
-                frame += ESC_COLOR_CODE;
-                frame += BACKGROUND_SEQUENCE
-                      + std::to_string(static_cast<int>(pix.background().r)) + SEQUENCE_ARG_SEPARATOR
-                      + std::to_string(static_cast<int>(pix.background().g)) + SEQUENCE_ARG_SEPARATOR
-                      + std::to_string(static_cast<int>(pix.background().b)) + CLOSE_SEQUENCE;
+    void feed(const char* data, size_t size, std::vector<keyEvent>& out) {
+        for (size_t i = 0; i < size; ++i)
+            feedByte(data[i], out);
+    }
 
-                if (pix.bold())     frame += SET_BOLD;
-                if (pix.blinking()) frame += SET_BLINKING;
+    bool pending() const { return !sequence_.empty(); }
 
-                frame += conv.to_bytes(c);
+    /* Deliver an unfinished sequence as the bytes it consists of */
+    void flush(std::vector<keyEvent>& out) {
+        for (char c : sequence_)
+            out.push_back({ static_cast<unsigned char>(c), std::string() });
+        sequence_.clear();
+    }
 
-                isChanged[row][col] = false;
-            }
-            frame += '\n';
+    /* The key for a scan code that follows a 0 or 224 from _getch(); 0 if none */
+    static int fromScanCode(int scan) {
+        switch (scan) {
+            case 72: return InputKeys::Up;
+            case 80: return InputKeys::Down;
+            case 75: return InputKeys::Left;
+            case 77: return InputKeys::Right;
+            case 71: return InputKeys::Home;
+            case 79: return InputKeys::End;
+            case 82: return InputKeys::Insert;
+            case 83: return InputKeys::Delete;
+            case 73: return InputKeys::PageUp;
+            case 81: return InputKeys::PageDown;
+            case 133: return InputKeys::F11;
+            case 134: return InputKeys::F12;
+            default:
+                return scan >= 59 && scan <= 68 ? InputKeys::F1 + (scan - 59) : 0;
         }
-
-        frame += RESET_ALL;
-        std::cout << frame << std::flush;
     }
 
-    /* Initialize console and buffers */
-    void init() {
-        std::cout << RESET_ALL << ERASE_CONSOLE;
+private:
+    struct sequenceKey {
+        const char* sequence;
+        int key;
+    };
 
-        #ifdef _WIN32
-            /* Switch Windows console to UTF-8 code page */
-            system("chcp 65001 >nul");
-        #endif
+    static const sequenceKey* table(size_t& count) {
+        static const sequenceKey keys[] = {
+            { "\033[A", InputKeys::Up },      { "\033OA", InputKeys::Up },
+            { "\033[B", InputKeys::Down },    { "\033OB", InputKeys::Down },
+            { "\033[C", InputKeys::Right },   { "\033OC", InputKeys::Right },
+            { "\033[D", InputKeys::Left },    { "\033OD", InputKeys::Left },
+            { "\033[H", InputKeys::Home },    { "\033OH", InputKeys::Home },
+            { "\033[F", InputKeys::End },     { "\033OF", InputKeys::End },
+            { "\033[1~", InputKeys::Home },   { "\033[7~", InputKeys::Home },
+            { "\033[4~", InputKeys::End },    { "\033[8~", InputKeys::End },
+            { "\033[2~", InputKeys::Insert }, { "\033[3~", InputKeys::Delete },
+            { "\033[5~", InputKeys::PageUp }, { "\033[6~", InputKeys::PageDown },
+            { "\033OP", InputKeys::F1 },      { "\033[11~", InputKeys::F1 },  { "\033[[A", InputKeys::F1 },
+            { "\033OQ", InputKeys::F2 },      { "\033[12~", InputKeys::F2 },  { "\033[[B", InputKeys::F2 },
+            { "\033OR", InputKeys::F3 },      { "\033[13~", InputKeys::F3 },  { "\033[[C", InputKeys::F3 },
+            { "\033OS", InputKeys::F4 },      { "\033[14~", InputKeys::F4 },  { "\033[[D", InputKeys::F4 },
+            { "\033[15~", InputKeys::F5 },    { "\033[[E", InputKeys::F5 },
+            { "\033[17~", InputKeys::F6 },    { "\033[18~", InputKeys::F7 },
+            { "\033[19~", InputKeys::F8 },    { "\033[20~", InputKeys::F9 },
+            { "\033[21~", InputKeys::F10 },   { "\033[23~", InputKeys::F11 },
+            { "\033[24~", InputKeys::F12 },
+        };
+        count = sizeof(keys) / sizeof(keys[0]);
+        return keys;
+    }
 
-        /* Query console size */
-        #ifdef _WIN32
-            CONSOLE_SCREEN_BUFFER_INFO csbi;
-            if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) {
-                width  = csbi.srWindow.Right  - csbi.srWindow.Left + 1;
-                height = csbi.srWindow.Bottom - csbi.srWindow.Top  + 1;
-            } else {
-                width = height = -1;
-            }
-        #else
-            struct winsize w;
-            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0) {
-                width  = w.ws_col;
-                height = w.ws_row;
-            } else {
-                width = height = -1;
+    void feedByte(char c, std::vector<keyEvent>& out) {
+        if (pasting_) {
+            static const char end[] = "\033[201~";
+            const size_t endLength = sizeof(end) - 1;
+            paste_ += c;
+            if (paste_.size() >= endLength && paste_.compare(paste_.size() - endLength, endLength, end) == 0) {
+                paste_.resize(paste_.size() - endLength);
+                out.push_back({ InputKeys::Paste, std::move(paste_) });
+                paste_.clear();
+                pasting_ = false;
             }
-        #endif
-
-        if (width < 1 || height < 1) {
-            std::cout << "Error getting console size";
             return;
         }
 
-        /* Reserve one row to avoid terminal bottomline overlapping */
-        --height;
-
-        buffer.assign(height, std::vector<char32_t>(width, U' '));
-        color_buffer.assign(height, std::vector<c_pixel>(width, c_pixel(color{255,255,255})));
-        isChanged.assign(height, std::vector<bool>(width, false));
-    }
-
-    /* Add a box border around the buffer and apply gradient */
-    void addBorder() {
-        borderEnabled = true;
-
-        buffer[0][0] = U'╔';
-        buffer[0][width-1] = U'╗';
-        buffer[height-1][0] = U'╚';
-        buffer[height-1][width-1] = U'╝';
+        if (sequence_.empty()) {
+            if (c == '\033') sequence_ += c;
+            else out.push_back({ static_cast<unsigned char>(c), std::string() });
+            return;
+        }
 
-        for (int i = 1; i < width - 1; ++i) {
-            buffer[0][i] = U'═';
-            buffer[height-1][i] = U'═';
+        const unsigned char u = static_cast<unsigned char>(c);
+        if (sequence_.size() == 1) {
+            if (c == '[' || c == 'O') {
+                sequence_ += c;
+                return;
+            }
+            /* Esc followed by anything else: two separate keys */
+            flush(out);
+            feedByte(c, out);
+            return;
         }
-        for (int i = 1; i < height - 1; ++i) {
-            buffer[i][0] = U'║';
-            buffer[i][width-1] = U'║';
+
+        if (sequence_[1] == 'O') {          /* SS3: ESC O <final> */
+            sequence_ += c;
+            finish(out);
+        } else if (sequence_.size() == 2 && c == '[') {
+            sequence_ += c;                 /* Linux console F1-F5: ESC [ [ <A-E> */
+        } else if (sequence_.size() == 3 && sequence_[2] == '[') {
+            sequence_ += c;
+            finish(out);
+        } else if (u >= 0x40 && u <= 0x7E) {
+            sequence_ += c;                 /* CSI final byte */
+            finish(out);
+        } else if (u >= 0x20 && u <= 0x3F && sequence_.size() < 16) {
+            sequence_ += c;                 /* CSI parameter / intermediate byte */
+        } else {
+            /* not a sequence after all */
+            flush(out);
+            feedByte(c, out);
         }
-        addGradient();
     }
 
-    /* Create a simple background gradient in color_buffer */
-    void addGradient() {
-        for (int row = 0; row < height; ++row) {
-            for (int col = 0; col < width; ++col) {
-                double perc_y = static_cast<double>(row) / static_cast<double>(height);
-                double perc_x = static_cast<double>(col) / static_cast<double>(width);
+    void finish(std::vector<keyEvent>& out) {
+        std::string key;
+        key.swap(sequence_);
 
-                unsigned char r = static_cast<unsigned char>(perc_y * 255.0);
-                unsigned char g = static_cast<unsigned char>(perc_x * (1.0 - perc_y) * 255.0);
-                unsigned char b = 250;
+        /* ESC[<n>;<modifiers><final> -> ESC[<n><final>, and ESC[1<final> -> ESC[<final> */
+        const size_t separator = key.find(';');
+        if (separator != std::string::npos)
+            key.erase(separator, key.size() - 1 - separator);
+        if (key.size() == 4 && key[2] == '1' && key[3] != '~')
+            key.erase(2, 1);
 
-                color new_color{r, g, b};
-                color_buffer[row][col].setForeground(new_color);
-            }
+        if (key == "\033[200~") {
+            pasting_ = true;
+            return;
         }
-    }
 
-    /* Select submenu by name (first match) */
-    void SelectSubMenu(const std::string& str) {
-        for (size_t i = 0; i < submenus.size(); ++i) {
-            if (submenus[i].name == str) {
-                currentMenu = static_cast<int>(i);
+        size_t count = 0;
+        const sequenceKey* keys = table(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (key == keys[i].sequence) {
+                out.push_back({ keys[i].key, std::string() });
                 return;
             }
         }
     }
 
-    /* Select submenu by index */
-    void SelectSubMenu(int index) {
-        if (index < 0 || index >= static_cast<int>(submenus.size())) return;
-        currentMenu = index;
-    }
-
-    /* Draw the full menu (title + options) to the terminal */
-    void DrawMenu() {
-        std::cout << ERASE_CONSOLE << RESET_ALL;
-
-        /* Reset the buffer to spaces */
-        buffer.assign(height, std::vector<char32_t>(width, U' '));
-
-        if (borderEnabled) addBorder();
-
-        const subMenu & menu = submenus.at(static_cast<size_t>(currentMenu));
-
-        /* Compute title metrics (how many columns in total, and title height) */
-        const int nr_chars = static_cast<int>(menu.name.length());
-        int total_length_in_Chars = 0;
-        int title_height_in_Chars = 0;
+    std::string sequence_;
+    std::string paste_;
+    bool pasting_;
+};
 
-        for (int i = 0; i < nr_chars; ++i) {
-            const Character* pch = (*(menu.titleFont))[menu.name[i]];
-            if (pch == nullptr) continue;
+/*
+ * rawTerminal
+ *
+ * While entered, stdin is non-canonical and does not echo, Enter arrives
+ * as 13 and pastes are bracketed; leave() (or the destructor) puts back
+ * what was there before. Does nothing when stdin is not a terminal, and
+ * on Windows, where _getch() already reads single keys.
+ */
+class rawTerminal {
+public:
+    rawTerminal() : active_(false) {}
+    ~rawTerminal() { leave(); }
+
+    rawTerminal(const rawTerminal&) = delete;
+    rawTerminal& operator=(const rawTerminal&) = delete;
+
+    bool active() const { return active_; }
+
+    void enter() {
+        #ifndef _WIN32
+            if (active_ || !isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_) != 0) return;
+            termios raw = saved_;
+            raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+            raw.c_iflag &= ~static_cast<tcflag_t>(ICRNL);
+            raw.c_cc[VMIN] = 1;
+            raw.c_cc[VTIME] = 0;
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+            control("\033[?2004h");
+            active_ = true;
+        #endif
+    }
 
-            int char_width = 0;
-            int char_height = pch->height;
-            for (int r = 0; r < char_height; ++r) {
-                int line_length = static_cast<int>(pch->data[r].size());
-                char_width = std::max(char_width, line_length);
-            }
+    void leave() {
+        #ifndef _WIN32
+            if (!active_) return;
+            control("\033[?2004l");
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved_);
+            active_ = false;
+        #endif
+    }
 
-            total_length_in_Chars += char_width;
-            title_height_in_Chars = std::max(title_height_in_Chars, char_height);
+private:
+    #ifndef _WIN32
+        /* Mode switches go to whichever of stdout/stderr is the terminal */
+        static void control(const char* sequence) {
+            const int fd = isatty(STDOUT_FILENO) ? STDOUT_FILENO : STDERR_FILENO;
+            if (!isatty(fd)) return;
+            std::cout.flush();
+            ssize_t written = ::write(fd, sequence, std::strlen(sequence));
+            (void)written;
         }
 
-        int absolute_top_left_x = static_cast<int>((buffer[0].size() / 2) - (total_length_in_Chars / 2));
-        int absolute_top_right_x = static_cast<int>((width / 2) + (total_length_in_Chars / 2));
-
-        int top_padding = 1;
-        if (borderEnabled) ++top_padding;
-        int absolute_bottom_y = title_height_in_Chars + top_padding;
-
-        /* Draw title glyphs into the buffer */
-        int start_x_position = absolute_top_left_x;
-        for (int i = 0; i < nr_chars; ++i) {
-            const Character* pch = (*(menu.titleFont))[menu.name[i]];
-            if (pch == nullptr) continue;
-
-            coords top_left_char_corner{ start_x_position, top_padding };
-
-            int char_width = 0;
-            for (size_t r = 0; r < pch->data.size(); ++r) {
-                int chr_length = static_cast<int>(pch->data[r].length());
-                char_width = std::max(char_width, chr_length);
-            }
+        termios saved_;
+    #endif
+    bool active_;
+};
 
-            start_x_position += char_width;
-            DrawOneChar(top_left_char_corner, pch);
+/*
+ * readKey()
+ *
+ * Wait for one key and return it: a byte, or an InputKeys code. Use it
+ * where getch() was used to wait for a key press outside startLoop(); any
+ * further keys that arrived in the same burst are discarded.
+ */
+inline int readKey() {
+    #ifdef _WIN32
+        const int c = _getch();
+        if (c == 0 || c == 224) {
+            const int scan = _getch();
+            const int key = keyDecoder::fromScanCode(scan);
+            return key ? key : scan;
         }
-
-        /* Optional per-title color function (fills title bounding box with colors) */
-        if (menu.colorFunction) {
-            for (int row = top_padding; row < title_height_in_Chars; ++row) {
-                for (int col = absolute_top_left_x; col < absolute_top_right_x; ++col) {
-                    double x = static_cast<double>(col) / static_cast<double>(absolute_top_right_x - absolute_top_left_x);
-                    double y = static_cast<double>(row) / static_cast<double>(title_height_in_Chars - top_padding);
-
-                    coords pos{ col, row };
-                    rawBufferDrawColor(pos, menu.colorFunction(x, y));
+        return c;
+    #else
+        rawTerminal raw;
+        raw.enter();
+        keyDecoder decoder;
+        std::vector<keyEvent> keys;
+        char bytes[256];
+        while (keys.empty()) {
+            if (decoder.pending()) {
+                pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+                if (poll(&fd, 1, keyDecoder::ESCAPE_DELAY_MS) == 0) {
+                    decoder.flush(keys);
+                    continue;
                 }
             }
+            const ssize_t got = ::read(STDIN_FILENO, bytes, sizeof(bytes));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return -1;
+            decoder.feed(bytes, static_cast<size_t>(got), keys);
         }
+        return keys.front().key;
+    #endif
+}
 
-        /* Print buffer to console */
-        printBuffer();
-
-        /* Draw the options listing on top (cursor-based printing) */
-        int option_y_level = absolute_bottom_y;
-        int option_x_level = top_padding;
-        c_pixel bar_color(menu.barColor);
-        cursor(option_x_level, option_y_level++);
-        bar_color.setTextColor();
-        std::cout << menu.barStyle.top;
+/* --------------------------------------------------------------------------
+   eventLoop - waits for keys, timers and resizes in one place
+   -------------------------------------------------------------------------- */
+/*
+ * run() sleeps in poll() on stdin, a timerfd armed for the earliest timer
+ * (Linux; elsewhere the poll timeout does the same job), a self-pipe
+ * written by the SIGWINCH handler and a wake pipe for post(), and
+ * dispatches from the calling thread:
+ *
+ * - onKey(key) for every key decoded from stdin (keyDecoder), onPaste(text)
+ *   for a bracketed paste,
+ * - the callbacks of the timers that are due (addTimer),
+ * - onResize() after the terminal window changed size,
+ * - functions handed to post() by other threads,
+ * - onIdle() once a batch of events has been handled; redraw there.
+ *
+ * Input is read in bulk: each wakeup drains whatever stdin has queued, so
+ * a burst of key repeats costs one onIdle() redraw, not one per key.
+ * While run() is active the terminal is in raw mode (rawTerminal);
+ * cooked() lends the normal mode back to code that reads lines or writes
+ * to the terminal itself. On Windows the loop waits on the console input
+ * handle and a wake event, reads keys with _getch() and compares the
+ * console size to notice resizes.
+ *
+ * A copy starts out empty (no callbacks, timers or posted functions):
+ * those usually point back at the object that owns the loop.
+ */
+class eventLoop {
+public:
+    typedef std::chrono::steady_clock clock;
+
+    eventLoop() : running_(false), nextTimerId_(0), posted_(nullptr) { openWake(); }
+    eventLoop(const eventLoop&) : eventLoop() {}
+    eventLoop& operator=(const eventLoop&) { return *this; }
+
+    ~eventLoop() {
+        runPosted(false);
+        #ifdef _WIN32
+            if (wake_) CloseHandle(wake_);
+        #else
+            for (int fd : wake_)
+                if (fd >= 0) close(fd);
+        #endif
+    }
+
+    std::function<void(int)> onKey;
+    std::function<void(const std::string&)> onPaste;
+    std::function<void()> onResize;
+    std::function<void()> onIdle;
+
+    /* Call tick every interval_ms until removeTimer(id); returns the id */
+    int addTimer(int interval_ms, std::function<void()> tick) {
+        timer t;
+        t.id = ++nextTimerId_;
+        t.interval = std::chrono::milliseconds(std::max(interval_ms, 1));
+        t.next = clock::now() + t.interval;
+        t.tick = std::move(tick);
+        timers_.push_back(std::move(t));
+        return nextTimerId_;
+    }
+
+    void removeTimer(int id) {
+        timers_.erase(std::remove_if(timers_.begin(), timers_.end(),
+                                     [id](const timer& t) { return t.id == id; }),
+                      timers_.end());
+    }
+
+    bool running() const { return running_; }
+    void stop() { running_ = false; }
+
+    /*
+     * Queue fn to run on the loop's thread and wake the loop; safe to call
+     * from any thread. The queue is a lock-free stack that the loop takes
+     * over in one exchange and replays oldest first.
+     */
+    void post(std::function<void()> fn) {
+        postedTask* task = new postedTask{ std::move(fn), posted_.load(std::memory_order_relaxed) };
+        while (!posted_.compare_exchange_weak(task->next, task,
+                                              std::memory_order_release, std::memory_order_relaxed)) {}
+        #ifdef _WIN32
+            if (wake_) SetEvent(wake_);
+        #else
+            if (wake_[1] >= 0) {
+                const char byte = 0;
+                ssize_t written = ::write(wake_[1], &byte, 1);   /* a full pipe already wakes */
+                (void)written;
+            }
+        #endif
+    }
+
+    /* Run fn with the terminal back in the mode it had before run() */
+    template <class Fn>
+    void cooked(Fn fn) {
+        const bool wasRaw = terminal_.active();
+        if (wasRaw) terminal_.leave();
+        fn();
+        if (wasRaw) terminal_.enter();
+    }
+
+    void run() {
+        running_ = true;
+        #ifdef _WIN32
+            runWindows();
+        #else
+            runPosix();
+        #endif
+        running_ = false;
+    }
+
+private:
+    enum : int { MAX_READS_PER_BATCH = 16 };
+
+    struct timer {
+        int id;
+        clock::duration interval;
+        clock::time_point next;
+        std::function<void()> tick;
+    };
+
+    struct postedTask {
+        std::function<void()> fn;
+        postedTask* next;
+    };
+
+    void openWake() {
+        #ifdef _WIN32
+            wake_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        #else
+            wake_[0] = wake_[1] = -1;
+            if (pipe(wake_) != 0) return;
+            for (int fd : wake_) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        #endif
+    }
+
+    /* Take everything post()ed so far and run it in posting order (or just free it) */
+    void runPosted(bool execute = true) {
+        postedTask* task = posted_.exchange(nullptr, std::memory_order_acquire);
+        postedTask* ordered = nullptr;
+        while (task) {
+            postedTask* next = task->next;
+            task->next = ordered;
+            ordered = task;
+            task = next;
+        }
+        while (ordered) {
+            std::unique_ptr<postedTask> current(ordered);
+            ordered = ordered->next;
+            if (execute && current->fn) current->fn();
+        }
+    }
+
+    void dispatch(std::vector<keyEvent>& keys) {
+        for (size_t i = 0; i < keys.size() && running_; ++i) {
+            if (keys[i].key == InputKeys::Paste) {
+                if (onPaste) onPaste(keys[i].text);
+            } else if (onKey) {
+                onKey(keys[i].key);
+            }
+        }
+        keys.clear();
+    }
+
+    /* Fire every due timer once; a timer that fell behind skips the missed ticks */
+    void runDueTimers() {
+        const clock::time_point now = clock::now();
+        for (size_t i = 0; i < timers_.size() && running_; ++i) {
+            timer& t = timers_[i];
+            if (t.next > now) continue;
+            t.next += t.interval;
+            if (t.next <= now) t.next = now + t.interval;
+            /* copied: the callback may add or remove timers */
+            std::function<void()> tick = t.tick;
+            tick();
+        }
+    }
+
+    bool nextDeadline(clock::time_point& deadline) const {
+        if (timers_.empty()) return false;
+        deadline = timers_[0].next;
+        for (const timer& t : timers_)
+            deadline = std::min(deadline, t.next);
+        return true;
+    }
+
+    /* Milliseconds until the earliest timer, -1 without timers */
+    int timeoutMs() const {
+        clock::time_point deadline;
+        if (!nextDeadline(deadline)) return -1;
+        const clock::duration left = deadline - clock::now();
+        if (left <= clock::duration::zero()) return 0;
+        std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(left);
+        if (ms < left) ++ms;    /* round up: waking early would spin */
+        return static_cast<int>(ms.count());
+    }
+
+#ifdef _WIN32
+    static bool consoleSize(int& w, int& h) {
+        CONSOLE_SCREEN_BUFFER_INFO csbi;
+        if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return false;
+        w = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+        h = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+        return true;
+    }
+
+    void runWindows() {
+        HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+        int w = 0, h = 0;
+        consoleSize(w, h);
+
+        if (onIdle) onIdle();
+        while (running_) {
+            /* the console has no resize signal for us; look at least every 100 ms */
+            int timeout = timeoutMs();
+            if (timeout < 0 || timeout > 100) timeout = 100;
+
+            HANDLE handles[2] = { input, wake_ };
+            const DWORD waited = WaitForMultipleObjects(wake_ ? 2 : 1, handles, FALSE, static_cast<DWORD>(timeout));
+            if (waited == WAIT_OBJECT_0) {
+                /* mouse, focus and key-up records also signal the handle; drop them */
+                INPUT_RECORD record;
+                DWORD count = 0;
+                while (PeekConsoleInput(input, &record, 1, &count) && count > 0 &&
+                       !(record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown))
+                    ReadConsoleInput(input, &record, 1, &count);
+
+                while (_kbhit()) {
+                    const int c = _getch();
+                    const int key = (c == 0 || c == 224) ? keyDecoder::fromScanCode(_getch()) : c;
+                    if (key) keys_.push_back({ key, std::string() });
+                }
+                dispatch(keys_);
+            }
+
+            int nw = 0, nh = 0;
+            if (running_ && consoleSize(nw, nh) && (nw != w || nh != h)) {
+                w = nw;
+                h = nh;
+                if (onResize) onResize();
+            }
+
+            if (running_) runPosted();
+            if (running_) runDueTimers();
+            if (running_ && onIdle) onIdle();
+        }
+    }
+#else
+    /* Self-pipe for SIGWINCH; created once, shared by every loop */
+    static int* resizePipe() {
+        static int fds[2] = { -1, -1 };
+        return fds;
+    }
+
+    static void onWinch(int) {
+        const int savedErrno = errno;
+        const char byte = 0;
+        ssize_t written = ::write(resizePipe()[1], &byte, 1);
+        (void)written;
+        errno = savedErrno;
+    }
+
+    static bool openResizePipe() {
+        int* fds = resizePipe();
+        if (fds[0] >= 0) return true;
+        if (pipe(fds) != 0) return false;
+        for (int i = 0; i < 2; ++i) {
+            fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        }
+        return true;
+    }
+
+    /*
+     * Decode everything stdin has queued, so that held-down keys are all
+     * applied before the next onIdle() redraw. Bounded per batch so a flood
+     * of input cannot hold the redraw back; returns false at end of file.
+     */
+    bool drainInput() {
+        char bytes[256];
+        for (int reads = 0; reads < MAX_READS_PER_BATCH; ++reads) {
+            const ssize_t got = ::read(STDIN_FILENO, bytes, sizeof(bytes));
+            if (got < 0 && errno == EINTR) continue;
+            if (got == 0) return false;
+            if (got < 0) break;
+            decoder_.feed(bytes, static_cast<size_t>(got), keys_);
+
+            pollfd more = { STDIN_FILENO, POLLIN, 0 };
+            if (poll(&more, 1, 0) <= 0 || !(more.revents & POLLIN)) break;
+        }
+        return true;
+    }
+
+#ifdef __linux__
+    /* Arm (or disarm) the timerfd for the earliest timer, as an absolute time */
+    void armTimerFd(int fd) const {
+        itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        clock::time_point deadline;
+        if (nextDeadline(deadline)) {
+            /* steady_clock is CLOCK_MONOTONIC; a zero it_value would disarm */
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            if (ns <= 0) ns = 1;
+            spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000LL);
+            spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000LL);
+        }
+        timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+#endif
+
+    void runPosix() {
+        const bool resizeWatched = openResizePipe();
+        struct sigaction action, previous;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = onWinch;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        if (resizeWatched) sigaction(SIGWINCH, &action, &previous);
+
+        #ifdef __linux__
+            const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        #else
+            const int timerFd = -1;
+        #endif
+
+        terminal_.enter();
+        if (onIdle) onIdle();
+
+        while (running_) {
+            pollfd fds[4];
+            nfds_t count = 0;
+            fds[count++] = { STDIN_FILENO, POLLIN, 0 };
+            fds[count++] = { resizePipe()[0], POLLIN, 0 };
+            fds[count++] = { wake_[0], POLLIN, 0 };
+
+            int timeout = -1;
+            #ifdef __linux__
+                if (timerFd >= 0) {
+                    armTimerFd(timerFd);
+                    fds[count++] = { timerFd, POLLIN, 0 };
+                } else {
+                    timeout = timeoutMs();
+                }
+            #else
+                timeout = timeoutMs();
+            #endif
+            /* give an unfinished escape sequence a moment to complete */
+            if (decoder_.pending() && (timeout < 0 || timeout > keyDecoder::ESCAPE_DELAY_MS))
+                timeout = keyDecoder::ESCAPE_DELAY_MS;
+
+            const int ready = poll(fds, count, timeout);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+
+            if (fds[1].revents & POLLIN) {
+                char drain[64];
+                while (::read(fds[1].fd, drain, sizeof(drain)) > 0) {}
+                if (onResize) onResize();
+            }
+
+            if (running_ && (fds[0].revents & POLLIN)) {
+                if (!drainInput()) running_ = false;
+                dispatch(keys_);
+                if (decoder_.pending()) escapeStart_ = clock::now();
+            } else if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                /* stdin is gone; nothing can drive the loop any more */
+                running_ = false;
+            } else if (decoder_.pending() &&
+                       clock::now() - escapeStart_ >= std::chrono::milliseconds(keyDecoder::ESCAPE_DELAY_MS)) {
+                /* nothing followed the escape: it was a key of its own */
+                decoder_.flush(keys_);
+                dispatch(keys_);
+            }
+
+            if (fds[2].revents & POLLIN) {
+                char drain[64];
+                while (::read(fds[2].fd, drain, sizeof(drain)) > 0) {}
+            }
+            /* also picks up tasks posted before run() started */
+            if (running_) runPosted();
+
+            #ifdef __linux__
+                if (count > 3 && (fds[3].revents & POLLIN)) {
+                    uint64_t expirations = 0;
+                    ssize_t got = ::read(timerFd, &expirations, sizeof(expirations));
+                    (void)got;
+                }
+            #endif
+
+            if (running_) runDueTimers();
+            if (running_ && onIdle) onIdle();
+        }
+
+        terminal_.leave();
+        if (timerFd >= 0) close(timerFd);
+        if (resizeWatched) sigaction(SIGWINCH, &previous, nullptr);
+    }
+#endif
+
+    bool running_;
+    int nextTimerId_;
+    std::vector<timer> timers_;
+    std::atomic<postedTask*> posted_;
+    #ifdef _WIN32
+        HANDLE wake_;
+    #else
+        int wake_[2];
+    #endif
+    rawTerminal terminal_;
+    keyDecoder decoder_;
+    clock::time_point escapeStart_;
+    std::vector<keyEvent> keys_;
+};
+
+/* --------------------------------------------------------------------------
+   workerPool - background threads for slow option callbacks
+   -------------------------------------------------------------------------- */
+/*
+ * Jobs are queued under a mutex and taken by a fixed set of threads
+ * (DEFAULT_THREADS unless the constructor says otherwise) that start on
+ * the first submit(), so menus that never go async never spawn any. Menu
+ * callbacks mostly wait on I/O, so the count does not follow the core
+ * count. The destructor lets the running jobs finish, drops the queued
+ * ones and joins. Like eventLoop, a copy or assignment takes over only
+ * the thread count, not jobs or threads.
+ */
+class workerPool {
+public:
+    enum : unsigned { DEFAULT_THREADS = 2 };
+
+    explicit workerPool(unsigned threads = DEFAULT_THREADS)
+        : threads_(std::max(threads, 1u)), stopping_(false) {}
+    workerPool(const workerPool& other) : threads_(other.threads_), stopping_(false) {}
+
+    /* Takes effect when the threads start, i.e. not once they are running */
+    workerPool& operator=(const workerPool& other) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_ = other.threads_;
+        return *this;
+    }
+
+    unsigned threads() const { return threads_; }
+
+    ~workerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            jobs_.clear();
+        }
+        ready_.notify_all();
+        for (std::thread& worker : workers_)
+            worker.join();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (workers_.empty()) start();
+            jobs_.push_back(std::move(job));
+        }
+        ready_.notify_one();
+    }
+
+private:
+    void start() {
+        for (unsigned i = 0; i < threads_; ++i)
+            workers_.emplace_back([this]() { work(); });
+    }
+
+    void work() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+                if (stopping_) return;
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+
+    unsigned threads_;
+    bool stopping_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> jobs_;
+    std::vector<std::thread> workers_;
+};
+
+/* --------------------------------------------------------------------------
+   terminal - capability queries
+   -------------------------------------------------------------------------- */
+namespace terminal {
+    /*
+     * supportsSynchronizedUpdates(timeout_ms) -> bool
+     *
+     * Asks the terminal (DECRQM) whether it knows mode 2026. A primary device
+     * attributes request is sent right after it; every terminal answers that
+     * one, so old terminals that ignore DECRQM do not cost the full timeout.
+     * Returns false when stdin/stdout is not a terminal or nothing answers.
+     */
+    inline bool supportsSynchronizedUpdates(int timeout_ms = 200) {
+        #ifdef _WIN32
+            (void)timeout_ms;
+            return false;
+        #else
+            if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) return false;
+
+            termios saved;
+            if (tcgetattr(STDIN_FILENO, &saved) != 0) return false;
+            termios raw = saved;
+            raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+            raw.c_cc[VMIN] = 0;
+            raw.c_cc[VTIME] = 0;
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+            std::cout.flush();
+            const char query[] = "\033[?2026$p\033[c";
+            if (::write(STDOUT_FILENO, query, sizeof(query) - 1) < 0) {
+                tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+                return false;
+            }
+
+            /* Collect replies until the device attributes answer (ESC [ ? ... c) */
+            std::string reply;
+            pollfd pfd{ STDIN_FILENO, POLLIN, 0 };
+            while (poll(&pfd, 1, timeout_ms) > 0) {
+                char chunk[64];
+                ssize_t n = ::read(STDIN_FILENO, chunk, sizeof(chunk));
+                if (n <= 0) break;
+                reply.append(chunk, static_cast<size_t>(n));
+
+                const size_t da = reply.rfind("\033[?");
+                if (da != std::string::npos && reply.find('c', da) != std::string::npos
+                    && reply.compare(da, 8, "\033[?2026;") != 0) break;
+            }
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+
+            /* ESC [ ? 2026 ; Ps $ y  with Ps 1 (set), 2 (reset) or 3 (permanently set) */
+            const size_t pos = reply.find("\033[?2026;");
+            if (pos == std::string::npos || pos + 8 >= reply.size()) return false;
+            const char state = reply[pos + 8];
+            return state == '1' || state == '2' || state == '3';
+        #endif
+    }
+}
+
+/* --------------------------------------------------------------------------
+   cell / cellGrid - the character grid cliMenu draws into
+   -------------------------------------------------------------------------- */
+/*
+ * cell - one terminal cell: its codepoint plus colors and attributes.
+ *
+ * The glyph's UTF-8 bytes are stored inline (encodedGlyph) and encoded once,
+ * when the glyph is set, so flushing a cell is a plain byte copy.
+ */
+class cell {
+public:
+    cell() : pixel(color{255,255,255}) {}
+
+    char32_t glyph() const noexcept { return text_.codepoint(); }
+    void setGlyph(char32_t c) noexcept { text_.set(c); }
+    void setGlyph(const encodedGlyph& g) noexcept { text_ = g; }
+
+    const char* utf8() const noexcept { return text_.utf8(); }
+    size_t utf8Length() const noexcept { return text_.utf8Length(); }
+
+    bool operator==(const cell& other) const noexcept {
+        return text_ == other.text_ && pixel == other.pixel;
+    }
+    bool operator!=(const cell& other) const noexcept { return !(*this == other); }
+
+    c_pixel pixel;
+
+private:
+    encodedGlyph text_;
+};
+
+/*
+ * cellGrid
+ *
+ * A row-major array of cells (index = y * width + x), so clears, blits and
+ * diffs walk memory linearly. operator()(x, y) is unchecked; callers clip first.
+ *
+ * Dirty tracking is per row: a bitmap of dirty rows plus an inclusive
+ * [dirtyBegin, dirtyEnd] column range for each of them, so a flush only
+ * visits what changed. Writing through operator()/row() does not mark
+ * anything; use markDirty() (the cliMenu rawBufferDraw* helpers do).
+ */
+class cellGrid {
+public:
+    cellGrid() : width_(0), height_(0) {}
+
+    /* Resize (reallocating only when the cell count grows) and fill */
+    void assign(int w, int h, const cell& fill_with = cell()) {
+        width_  = std::max(0, w);
+        height_ = std::max(0, h);
+        cells_.assign(static_cast<size_t>(width_) * static_cast<size_t>(height_), fill_with);
+        dirtyRows_.assign((static_cast<size_t>(height_) + 63) / 64, 0);
+        dirtyBegin_.assign(height_, width_);
+        dirtyEnd_.assign(height_, -1);
+    }
+
+    /* Overwrite every cell without touching the allocation */
+    void fill(const cell& fill_with) {
+        std::fill(cells_.begin(), cells_.end(), fill_with);
+        markAllDirty();
+    }
+
+    int width() const noexcept  { return width_; }
+    int height() const noexcept { return height_; }
+    bool sameSize(const cellGrid& other) const noexcept {
+        return width_ == other.width_ && height_ == other.height_;
+    }
+
+    cell& operator()(int x, int y) noexcept { return cells_[index(x, y)]; }
+    const cell& operator()(int x, int y) const noexcept { return cells_[index(x, y)]; }
+
+    cell* row(int y) noexcept { return cells_.data() + index(0, y); }
+    const cell* row(int y) const noexcept { return cells_.data() + index(0, y); }
+
+    /* Copy row y from a grid of the same size and mark it dirty */
+    void copyRow(const cellGrid& from, int y) {
+        std::copy(from.row(y), from.row(y) + width_, row(y));
+        markRowDirty(y);
+    }
+
+    /*
+     * Copy count pre-encoded glyphs to row y starting at column x, clipped
+     * to the grid; cell colors are kept. The pixel overload recolors too.
+     */
+    void blitGlyphs(int x, int y, const encodedGlyph* src, int count) {
+        int x0, x1;
+        if (!clip(x, y, count, x0, x1)) return;
+        cell* dst = row(y) + x0;
+        src += x0 - x;
+        for (int i = 0; i < x1 - x0; ++i) dst[i].setGlyph(src[i]);
+        markDirty(x0, x1 - 1, y);
+    }
+    void blitGlyphs(int x, int y, const encodedGlyph* src, int count, const c_pixel& pixel) {
+        int x0, x1;
+        if (!clip(x, y, count, x0, x1)) return;
+        cell* dst = row(y) + x0;
+        src += x0 - x;
+        for (int i = 0; i < x1 - x0; ++i) {
+            dst[i].setGlyph(src[i]);
+            dst[i].pixel = pixel;
+        }
+        markDirty(x0, x1 - 1, y);
+    }
+
+    /* Set the glyph of count cells of row y starting at column x, clipped */
+    void fillGlyphs(int x, int y, int count, const encodedGlyph& glyph) {
+        int x0, x1;
+        if (!clip(x, y, count, x0, x1)) return;
+        cell* dst = row(y);
+        for (int i = x0; i < x1; ++i) dst[i].setGlyph(glyph);
+        markDirty(x0, x1 - 1, y);
+    }
+
+    /* Copy every cell of a grid of the same size and mark all rows dirty */
+    void copyFrom(const cellGrid& from) {
+        if (!sameSize(from)) return;
+        std::copy(from.cells_.begin(), from.cells_.end(), cells_.begin());
+        markAllDirty();
+    }
+
+    /* Copy the w x h block at (fromX, fromY) of another grid to (x, y), clipped to both */
+    void copyRect(const cellGrid& from, int fromX, int fromY, int x, int y, int w, int h) {
+        if (fromX < 0) { x -= fromX; w += fromX; fromX = 0; }
+        if (fromY < 0) { y -= fromY; h += fromY; fromY = 0; }
+        if (x < 0) { fromX -= x; w += x; x = 0; }
+        if (y < 0) { fromY -= y; h += y; y = 0; }
+        w = std::min({ w, from.width_ - fromX, width_ - x });
+        h = std::min({ h, from.height_ - fromY, height_ - y });
+        if (w <= 0 || h <= 0) return;
+
+        for (int r = 0; r < h; ++r) {
+            const cell* src = from.row(fromY + r) + fromX;
+            std::copy(src, src + w, row(y + r) + x);
+            markDirty(x, x + w - 1, y + r);
+        }
+    }
+
+    /* Mark columns [x0, x1] of row y as changed */
+    void markDirty(int x0, int x1, int y) noexcept {
+        dirtyRows_[static_cast<size_t>(y) / 64] |= uint64_t(1) << (y % 64);
+        dirtyBegin_[y] = std::min(dirtyBegin_[y], x0);
+        dirtyEnd_[y]   = std::max(dirtyEnd_[y], x1);
+    }
+    void markDirty(int x, int y) noexcept { markDirty(x, x, y); }
+    void markRowDirty(int y) noexcept { markDirty(0, width_ - 1, y); }
+
+    void markAllDirty() noexcept {
+        for (int y = 0; y < height_; ++y) markRowDirty(y);
+    }
+
+    bool rowDirty(int y) const noexcept {
+        return (dirtyRows_[static_cast<size_t>(y) / 64] >> (y % 64)) & 1;
+    }
+    int dirtyBegin(int y) const noexcept { return dirtyBegin_[y]; }
+    int dirtyEnd(int y) const noexcept   { return dirtyEnd_[y]; }
+
+    /* First dirty row >= from, or -1; skips 64 clean rows per bitmap word */
+    int nextDirtyRow(int from) const noexcept {
+        for (int y = std::max(0, from); y < height_; ) {
+            const uint64_t word = dirtyRows_[static_cast<size_t>(y) / 64] >> (y % 64);
+            if (word == 0) { y = (y / 64 + 1) * 64; continue; }
+            if (word & 1) return y;
+            ++y;
+        }
+        return -1;
+    }
+
+    void clearDirty(int y) noexcept {
+        dirtyRows_[static_cast<size_t>(y) / 64] &= ~(uint64_t(1) << (y % 64));
+        dirtyBegin_[y] = width_;
+        dirtyEnd_[y] = -1;
+    }
+    void clearDirty() noexcept {
+        for (int y = nextDirtyRow(0); y >= 0; y = nextDirtyRow(y + 1)) clearDirty(y);
+    }
+
+private:
+    size_t index(int x, int y) const noexcept {
+        return static_cast<size_t>(y) * static_cast<size_t>(width_) + static_cast<size_t>(x);
+    }
+
+    /* Clip the span [x, x + count) of row y to the grid; false when empty */
+    bool clip(int x, int y, int count, int& x0, int& x1) const noexcept {
+        if (y < 0 || y >= height_) return false;
+        x0 = std::max(x, 0);
+        x1 = static_cast<int>(std::min<long long>(static_cast<long long>(x) + count, width_));
+        return x0 < x1;
+    }
+
+    int width_;
+    int height_;
+    std::vector<cell> cells_;
+    std::vector<uint64_t> dirtyRows_;
+    std::vector<int> dirtyBegin_;
+    std::vector<int> dirtyEnd_;
+};
+
+/*
+ * titleBlock
+ *
+ * A submenu title as it was last rendered: glyphs and colors for the title's
+ * bounding box, plus the key it was rendered under. While the key matches,
+ * drawing the title is one cellGrid::copyRect.
+ */
+struct titleBlock {
+    struct key {
+        unsigned long long layout = 0;     /* titleLayout::generation() */
+        unsigned int revision = 0;         /* subMenu::revision */
+        int width = 0;
+        int height = 0;
+        bool border = false;
+        bool colored = false;
+        c_pixel (*colorFunction)(double, double) = nullptr;
+        void (*colorSpan)(const double*, int, double, c_pixel*) = nullptr;
+
+        bool operator==(const key & other) const {
+            return layout == other.layout && revision == other.revision
+                && width == other.width && height == other.height
+                && border == other.border && colored == other.colored
+                && colorFunction == other.colorFunction
+                && colorSpan == other.colorSpan;
+        }
+    };
+
+    bool valid = false;
+    key id;
+    cellGrid cells;
+};
+
+/*
+ * GradientDirection::EnumDirection - the axis a gradientRamp runs along.
+ */
+namespace GradientDirection {
+    enum EnumDirection {
+        Horizontal,
+        Vertical
+    };
+}
+
+/*
+ * SynchronizedUpdates::EnumMode - whether cliMenu brackets frames in mode 2026.
+ * Auto asks the terminal once and falls back to Off when it does not answer.
+ */
+namespace SynchronizedUpdates {
+    enum EnumMode {
+        Off,
+        On,
+        Auto
+    };
+}
+
+/* --------------------------------------------------------------------------
+   cliMenu - main interactive menu system
+   -------------------------------------------------------------------------- */
+/*
+ * cliMenu
+ *
+ * - Manages a character buffer, color buffer and prints to the console.
+ * - Preserves original public API (init, addBorder, DrawMenu, startLoop, etc).
+ */
+class cliMenu {
+public:
+    cliMenu() : width(0), height(0), borderEnabled(false), doubleBuffered(false),
+                synchronizedUpdates(false), retainedMode(false), currentMenu(0),
+                frontValid(false), sink(std::make_shared<frameSink>()), exit(false) {
+        init();
+    }
+
+    /* Send frames to a different sink (e.g. another fd, or a capturing subclass) */
+    void setSink(std::shared_ptr<frameSink> new_sink) {
+        if (!new_sink) return;
+        sink = std::move(new_sink);
+        invalidateFrontBuffer();
+    }
+
+    /*
+     * setDoubleBuffering(on)
+     *
+     * When enabled, printBuffer() keeps a copy of the last frame it sent (the
+     * front buffer) and only emits cursor moves plus the cells that differ.
+     * Anything that writes to the terminal behind the menu's back must call
+     * invalidateFrontBuffer() so the next frame is a full repaint.
+     */
+    void setDoubleBuffering(bool on) {
+        doubleBuffered = on;
+        invalidateFrontBuffer();
+    }
+
+    void invalidateFrontBuffer() {
+        frontValid = false;
+    }
+
+    /*
+     * setRetainedMode(on)
+     *
+     * When enabled, DrawMenu() keeps the grid it built last time. A selection
+     * change then repaints only the previously and newly selected option rows;
+     * the title and the full layout are rebuilt only when the submenu, the
+     * terminal size, the border or the submenu's content (see
+     * subMenu::markChanged) changes. Code that draws into the grid between
+     * DrawMenu() calls must call invalidateLayout().
+     */
+    void setRetainedMode(bool on) {
+        retainedMode = on;
+        invalidateLayout();
+    }
+
+    void invalidateLayout() {
+        layout.valid = false;
+    }
+
+    /*
+     * setSynchronizedUpdates(mode)
+     *
+     * When on, every frame is wrapped in BEGIN/END_SYNCHRONIZED_UPDATE so the
+     * terminal presents it in one go instead of painting it as it arrives.
+     */
+    void setSynchronizedUpdates(SynchronizedUpdates::EnumMode mode) {
+        synchronizedUpdates = mode == SynchronizedUpdates::On
+            || (mode == SynchronizedUpdates::Auto && terminal::supportsSynchronizedUpdates());
+    }
+
+    /* Start a frame in the sink; returns the frame and its size before any content */
+    std::string & beginFrame(size_t & empty_size) {
+        std::string & frame = sink->frame();
+        if (synchronizedUpdates) frame += BEGIN_SYNCHRONIZED_UPDATE;
+        empty_size = frame.size();
+        return frame;
+    }
+
+    /* Close and send the frame; a frame with no content is dropped */
+    void endFrame(size_t empty_size) {
+        std::string & frame = sink->frame();
+        if (frame.size() == empty_size) {
+            frame.clear();
+            return;
+        }
+        if (synchronizedUpdates) frame += END_SYNCHRONIZED_UPDATE;
+        sink->flush();
+    }
 
-        for (size_t i = 0; i < menu.options.size(); ++i) {
-            if (menu.barStyle.gap) {
-                cursor(option_x_level, option_y_level++);
-                bar_color.setTextColor();
-                std::cout << menu.barStyle.between_gap;
+    /* Print only changed cells */
+    void printChanges() {
+        size_t empty_size = 0;
+        std::string & frame = beginFrame(empty_size);
+        sgrState sgr;
+
+        for (int row = cells.nextDirtyRow(0); row >= 0; row = cells.nextDirtyRow(row + 1)) {
+            const cell * line = cells.row(row);
+            const int last = cells.dirtyEnd(row);
+
+            appendCursor(frame, cells.dirtyBegin(row), row);
+            for (int col = cells.dirtyBegin(row); col <= last; ++col) {
+                sgr.apply(frame, line[col].pixel);
+                frame.append(line[col].utf8(), line[col].utf8Length());
             }
+            cells.clearDirty(row);
+        }
+
+        if (frame.size() != empty_size) frame += RESET_ALL;
+        endFrame(empty_size);
+    }
+
+    /* Append an absolute cursor move (0-based x/y) to a frame */
+    static void appendCursor(std::string & frame, int x, int y) {
+        char seq[escape::MAX_CURSOR_LENGTH];
+        frame.append(seq, static_cast<size_t>(escape::cursorTo(seq, x, y) - seq));
+    }
+
+    /*
+     * Print the buffer.
+     * Without double buffering (or when the front buffer is stale) this is a
+     * full repaint; otherwise only the cells that differ from the last frame.
+     */
+    void printBuffer() {
+        if (doubleBuffered && frontValid && front.sameSize(cells)) {
+            printDiff();
+            return;
+        }
+
+        size_t empty_size = 0;
+        std::string & frame = beginFrame(empty_size);
+        frame.reserve(static_cast<size_t>(width) * static_cast<size_t>(height) * 8);
 
-            cursor(option_x_level, option_y_level++);
-            bar_color.setTextColor();
+        /* clear screen (a full reset would also end the synchronized update) */
+        frame += synchronizedUpdates ? ERASE_SCREEN : ERASE_CONSOLE;
+        frame += START_SEQUENCE "H"; /* cursor home */
 
-            if (static_cast<int>(i) == menu.selectedOption) {
-                std::cout << menu.barStyle.selected;
-            } else {
-                std::cout << menu.barStyle.before_option;
+        sgrState sgr;
+        for (int row = 0; row < height; ++row) {
+            const cell * line = cells.row(row);
+            for (int col = 0; col < width; ++col) {
+                sgr.apply(frame, line[col].pixel);
+                frame.append(line[col].utf8(), line[col].utf8Length());
             }
+            frame += '\n';
+        }
+        cells.clearDirty();
+
+        frame += RESET_ALL;
+        endFrame(empty_size);
+
+        if (doubleBuffered) {
+            front = cells;
+            frontValid = true;
+        }
+    }
 
-            c_pixel option_color = (static_cast<int>(i) == menu.selectedOption)
-                                     ? c_pixel(menu.selectedColor)
-                                     : c_pixel(menu.defaultColor);
+    /* Emit only the dirty cells that differ from the front buffer, then update it */
+    void printDiff() {
+        size_t empty_size = 0;
+        std::string & frame = beginFrame(empty_size);
+        sgrState sgr;
+        int cursor_x = -1, cursor_y = -1;
+
+        for (int row = cells.nextDirtyRow(0); row >= 0; row = cells.nextDirtyRow(row + 1)) {
+            const cell * back_line = cells.row(row);
+            cell * front_line = front.row(row);
+            const int last = cells.dirtyEnd(row);
+
+            for (int col = cells.dirtyBegin(row); col <= last; ++col) {
+                const cell & c = back_line[col];
+                if (c == front_line[col]) continue;
+
+                if (col != cursor_x || row != cursor_y) appendCursor(frame, col, row);
+                sgr.apply(frame, c.pixel);
+                frame.append(c.utf8(), c.utf8Length());
+
+                front_line[col] = c;
+                cursor_x = col + 1;
+                cursor_y = row;
+            }
+        }
 
-            if (menu.options[i].overwriteColor_huh)
-                option_color = menu.options[i].overwiteColor;
+        cells.clearDirty();
 
-            option_color.setTextColor();
-            std::cout << menu.options[i].text;
-            bar_color.setTextColor();
-            std::cout << menu.barStyle.after_option;
+        /* Park the cursor where a full repaint would leave it */
+        if (frame.size() != empty_size) {
+            frame += RESET_ALL;
+            appendCursor(frame, 0, height);
         }
+        endFrame(empty_size);
     }
 
-    /* Remove title glyphs by writing space into the same region */
-    void removeTitleFromBuffer() {
-        const subMenu & menu = submenus.at(static_cast<size_t>(currentMenu));
-        const int nr_chars = static_cast<int>(menu.name.length());
-        int total_length_in_Chars = 0;
-        int title_height_in_Chars = 0;
+    /* Initialize console and buffers */
+    void init() {
+        sink->append(RESET_ALL ERASE_CONSOLE);
+        sink->flush();
+        invalidateFrontBuffer();
+        invalidateLayout();
+        baseLayerValid = false;
 
-        for (int i = 0; i < nr_chars; ++i) {
-            const Character* pch = (*(menu.titleFont))[menu.name[i]];
-            if (pch == nullptr) continue;
+        #ifdef _WIN32
+            /* Switch Windows console to UTF-8 code page */
+            system("chcp 65001 >nul");
+        #endif
+
+        if (!querySize(width, height)) {
+            width = height = -1;
+            std::cout << "Error getting console size";
+            return;
+        }
+
+        /* Reserve one row to avoid terminal bottomline overlapping */
+        --height;
+
+        cells.assign(width, height);
+    }
+
+    /* Console size in cells; false when it cannot be queried */
+    static bool querySize(int& w, int& h) {
+        #ifdef _WIN32
+            CONSOLE_SCREEN_BUFFER_INFO csbi;
+            if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return false;
+            w = csbi.srWindow.Right  - csbi.srWindow.Left + 1;
+            h = csbi.srWindow.Bottom - csbi.srWindow.Top  + 1;
+        #else
+            struct winsize ws;
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0) return false;
+            w = ws.ws_col;
+            h = ws.ws_row;
+        #endif
+        return w > 0 && h > 0;
+    }
+
+    /*
+     * resize()
+     *
+     * Picks up a new console size without init(): no console reset and no
+     * reallocation unless the grid grows. Every cell of a menu depends on
+     * the size (centered title, right and bottom border, gradient scaled
+     * to the grid), so the front buffer is dropped and the next frame is
+     * one full repaint. Caches keyed by the size (layout, base layer,
+     * gradient, title blocks) rebuild on the next DrawMenu(); fonts,
+     * atlases and colors are kept. Returns false when the size has not
+     * changed. startLoop() calls it on resize.
+     */
+    bool resize() {
+        int w = 0, h = 0;
+        if (!querySize(w, h)) return false;
+        --h; /* same reserved bottom row as init() */
+        if (w == width && h == height) return false;
+
+        width = w;
+        height = h;
+        cells.assign(width, height);
+        invalidateFrontBuffer();
+        return true;
+    }
+
+    /* Add a box border around the buffer and apply gradient */
+    void addBorder() {
+        borderEnabled = true;
+        drawBorder(cells);
+        addGradient();
+    }
+
+    /* Box-drawing frame around the edge of grid */
+    static void drawBorder(cellGrid & grid) {
+        const int w = grid.width(), h = grid.height();
+        if (w < 1 || h < 1) return;
 
-            int char_width = 0;
-            int char_height = pch->height;
-            for (int r = 0; r < char_height; ++r)
-                char_width = std::max(char_width, static_cast<int>(pch->data[r].size()));
+        grid(0, 0).setGlyph(U'╔');
+        grid(w-1, 0).setGlyph(U'╗');
+        grid(0, h-1).setGlyph(U'╚');
+        grid(w-1, h-1).setGlyph(U'╝');
 
-            total_length_in_Chars += char_width;
-            title_height_in_Chars = std::max(title_height_in_Chars, char_height);
+        for (int i = 1; i < w - 1; ++i) {
+            grid(i, 0).setGlyph(U'═');
+            grid(i, h-1).setGlyph(U'═');
         }
+        for (int i = 1; i < h - 1; ++i) {
+            grid(0, i).setGlyph(U'║');
+            grid(w-1, i).setGlyph(U'║');
+        }
+        grid.markAllDirty();
+    }
+
+    /*
+     * The layer every full DrawMenu() starts from: blank cells, plus the
+     * border and its gradient when borderEnabled. Built once per size and
+     * border setting instead of redrawn every frame.
+     */
+    bool baseLayerMatches() const {
+        return baseLayerValid && baseLayerBorder == borderEnabled
+            && baseLayer.width() == width && baseLayer.height() == height;
+    }
+
+    void buildBaseLayer() {
+        baseLayer.assign(width, height);
+        if (borderEnabled) {
+            drawBorder(baseLayer);
+            applyGradient(baseLayer, separableGradient::classic());
+        }
+        baseLayerBorder = borderEnabled;
+        baseLayerValid = true;
+    }
+
+    /* Create a simple background gradient in the cell colors */
+    void addGradient() {
+        addGradient(separableGradient::classic());
+    }
+
+    /*
+     * Foreground gradient from separable terms: the column and row terms
+     * are computed once each and combined per cell. The combined colors
+     * are kept and reused until the size or the coefficients change.
+     */
+    void addGradient(const separableGradient & gradient) {
+        applyGradient(cells, gradient);
+    }
+
+    void applyGradient(cellGrid & grid, const separableGradient & gradient) {
+        if (!gradientCache.valid || gradientCache.width != width || gradientCache.height != height
+            || gradientCache.gradient != gradient)
+            buildGradient(gradient);
+        if (grid.width() != width || grid.height() != height) return;
+
+        const color * colors = gradientCache.colors.data();
+        for (int row = 0; row < height; ++row) {
+            cell * line = grid.row(row);
+            for (int col = 0; col < width; ++col) line[col].pixel.setForeground(*colors++);
+        }
+        grid.markAllDirty();
+    }
+
+    /* Foreground gradient from a ramp sampled to the width (Horizontal) or height (Vertical) */
+    void addGradient(gradientRamp & ramp, GradientDirection::EnumDirection direction = GradientDirection::Horizontal) {
+        if (direction == GradientDirection::Horizontal) {
+            const std::vector<color> & colors = ramp.sample(static_cast<size_t>(std::max(width, 0)));
+            for (int row = 0; row < height; ++row) {
+                cell * line = cells.row(row);
+                for (int col = 0; col < width; ++col) line[col].pixel.setForeground(colors[col]);
+            }
+        } else {
+            const std::vector<color> & colors = ramp.sample(static_cast<size_t>(std::max(height, 0)));
+            for (int row = 0; row < height; ++row) {
+                cell * line = cells.row(row);
+                for (int col = 0; col < width; ++col) line[col].pixel.setForeground(colors[row]);
+            }
+        }
+        cells.markAllDirty();
+    }
+
+    /* Evaluate a separableGradient for the current size into gradientCache */
+    void buildGradient(const separableGradient & gradient) {
+        const int w = std::max(width, 0), h = std::max(height, 0);
+        const separableGradient::channel * channels[3] = { &gradient.r, &gradient.g, &gradient.b };
+
+        /* Column terms once per column; row terms below once per row */
+        std::vector<double> & columns = gradientCache.columns;
+        columns.resize(static_cast<size_t>(w) * 3);
+        for (int c = 0; c < 3; ++c) {
+            for (int col = 0; col < w; ++col) {
+                const double x = static_cast<double>(col) / static_cast<double>(w);
+                columns[static_cast<size_t>(c) * w + col] = channels[c]->x0 + channels[c]->x1 * x;
+            }
+        }
+
+        /*
+         * Each channel of a row is combined into its own contiguous byte
+         * row (straight loops over plain arrays, which the compiler
+         * vectorizes), then the three rows are packed into colors at once.
+         */
+        std::vector<unsigned char> & bytes = gradientCache.rowBytes;
+        bytes.resize(static_cast<size_t>(w) * 3);
+        std::vector<color> & colors = gradientCache.colors;
+        colors.resize(static_cast<size_t>(w) * static_cast<size_t>(h));
+        for (int row = 0; row < h; ++row) {
+            const double y = static_cast<double>(row) / static_cast<double>(h);
+
+            for (int c = 0; c < 3; ++c) {
+                const separableGradient::channel & ch = *channels[c];
+                const double scale = ch.y0 + ch.y1 * y;
+                const double gain = ch.gain;
+                const double offset = ch.o0 + ch.o1 * y;
+                const double * column = columns.data() + static_cast<size_t>(c) * w;
+                unsigned char * out = bytes.data() + static_cast<size_t>(c) * w;
+
+                if (w > 0 && ch.x1 == 0.0) {
+                    /* Row-only channel: one value for the whole row */
+                    std::fill(out, out + w, gradientByte(column[0] * scale * gain + offset));
+                } else {
+                    for (int col = 0; col < w; ++col) {
+                        double v = column[col] * scale * gain + offset;
+                        v = v < 0.0 ? 0.0 : v;
+                        v = v > 255.0 ? 255.0 : v;
+                        out[col] = static_cast<unsigned char>(static_cast<int>(v));
+                    }
+                }
+            }
+
+            const unsigned char * r = bytes.data();
+            const unsigned char * g = r + w;
+            const unsigned char * b = g + w;
+            color * line = colors.data() + static_cast<size_t>(row) * w;
+            for (int col = 0; col < w; ++col) {
+                line[col].r = r[col];
+                line[col].g = g[col];
+                line[col].b = b[col];
+            }
+        }
+
+        gradientCache.gradient = gradient;
+        gradientCache.width = width;
+        gradientCache.height = height;
+        gradientCache.valid = true;
+    }
+
+    static unsigned char gradientByte(double v) {
+        return static_cast<unsigned char>(std::min(std::max(v, 0.0), 255.0));
+    }
+
+    /* Select submenu by name (first match) */
+    void SelectSubMenu(const std::string& str) {
+        for (size_t i = 0; i < submenus.size(); ++i) {
+            if (submenus[i].name == str) {
+                currentMenu = static_cast<int>(i);
+                return;
+            }
+        }
+    }
+
+    /* Select submenu by index */
+    void SelectSubMenu(int index) {
+        if (index < 0 || index >= static_cast<int>(submenus.size())) return;
+        currentMenu = index;
+    }
+
+    /* Draw the full menu (title + options) to the terminal */
+    void DrawMenu() {
+        subMenu & menu = submenus.at(static_cast<size_t>(currentMenu));
+
+        if (retainedMode && layoutMatches(menu)) {
+            if (menu.selectedOption != layout.selected) {
+                redrawOption(menu, layout.selected);
+                redrawOption(menu, menu.selectedOption);
+                layout.selected = menu.selectedOption;
+            }
+            drawBusyIndicator();
+            printBuffer();
+            return;
+        }
+
+        /* Start from the blank-or-bordered base layer (printBuffer clears the screen when it needs to) */
+        if (!baseLayerMatches()) buildBaseLayer();
+        cells.copyFrom(baseLayer);
 
-        int absolute_top_left_x = static_cast<int>((buffer[0].size() / 2) - (total_length_in_Chars / 2));
-        int absolute_top_right_x = static_cast<int>((width / 2) + (total_length_in_Chars / 2));
+        /* Title metrics (total columns and height), re-measured only when they change */
+        const titleLayout & title = menuTitle(menu);
+        int title_height_in_Chars = title.height();
+
+        int absolute_top_left_x = title.left();
+        int absolute_top_right_x = title.right();
 
         int top_padding = 1;
         if (borderEnabled) ++top_padding;
         int absolute_bottom_y = title_height_in_Chars + top_padding;
 
-        int start_x_position = absolute_top_left_x;
-        for (int i = 0; i < nr_chars; ++i) {
-            const Character* pch = (*(menu.titleFont))[menu.name[i]];
-            if (pch == nullptr) continue;
+        /* The finished title cells are cached per submenu; a cache hit is one block copy */
+        titleBlock & block = titleBlockFor(menu);
+        const titleBlock::key block_key = titleBlockKey(menu, title);
+        const bool cacheable = titleCacheable(menu);
 
-            coords top_left_char_corner{ start_x_position, top_padding };
+        if (cacheable && block.valid && block.id == block_key) {
+            cells.copyRect(block.cells, 0, 0, absolute_top_left_x, top_padding,
+                           block.cells.width(), block.cells.height());
+        } else {
+            /* Draw title glyphs into the buffer */
+            for (const titleLayout::placedGlyph & placed : title.glyphs())
+                DrawOneChar({ absolute_top_left_x + placed.offset, top_padding }, *title.font(), placed.glyph);
+
+            /* Optional per-title color function (fills title bounding box with colors) */
+            if (menu.colorFunction || menu.colorSpan) {
+                DrawColorSpans({ absolute_top_left_x, top_padding },
+                               { absolute_top_right_x, title_height_in_Chars },
+                               { 0, 0 },
+                               absolute_top_right_x - absolute_top_left_x,
+                               title_height_in_Chars - top_padding,
+                               menu.titleColoring());
+            }
 
-            int char_width = 0;
-            for (size_t r = 0; r < pch->data.size(); ++r) {
-                char_width = std::max(char_width, static_cast<int>(pch->data[r].length()));
+            block.valid = cacheable;
+            if (cacheable) {
+                block.cells.assign(title.width(), title.rows());
+                block.cells.copyRect(cells, absolute_top_left_x, top_padding, 0, 0,
+                                     title.width(), title.rows());
+                block.id = block_key;
             }
+        }
+
+        /* Option rows are restored from this copy when the selection moves */
+        if (retainedMode) optionBase = cells;
+
+        /* Draw the options listing into the buffer, below the title */
+        int option_y_level = absolute_bottom_y;
+        int option_x_level = top_padding;
+        c_pixel bar_color(menu.barColor);
+        DrawText({ option_x_level, option_y_level++ }, menu.barStyle.top, bar_color);
+
+        layout.optionRows.clear();
+        for (size_t i = 0; i < menu.options.size(); ++i) {
+            if (menu.barStyle.gap)
+                DrawText({ option_x_level, option_y_level++ }, menu.barStyle.between_gap, bar_color);
 
-            start_x_position += char_width;
-            DrawOnMask(top_left_char_corner, pch, U' ');
+            layout.optionRows.push_back(option_y_level);
+            DrawOption(menu, i, { option_x_level, option_y_level++ });
         }
+
+        layout.valid = retainedMode;
+        layout.menu = currentMenu;
+        layout.width = width;
+        layout.height = height;
+        layout.border = borderEnabled;
+        layout.revision = menu.revision;
+        layout.name = menu.name;
+        layout.optionCount = menu.options.size();
+        layout.selected = menu.selectedOption;
+        layout.optionX = option_x_level;
+
+        drawBusyIndicator();
+
+        /* Print buffer to console */
+        printBuffer();
     }
 
-    /* Draw a glyph into the buffer but replacing glyph pixels with a given mask char */
-    void DrawOnMask(coords start, const Character* pToPrint, char32_t char_to_print) {
-        const Character& toPrint = *pToPrint;
-        for (int char_y = 0; char_y < static_cast<int>(toPrint.data.size()); ++char_y) {
-            for (int char_x = 0; char_x < static_cast<int>(toPrint.data[char_y].length()); ++char_x) {
-                coords pos{ start.x + char_x, start.y + char_y };
-                rawBufferDrawChar(pos, char_to_print);
-            }
+    /* Draw one option line (bar, text, bar) starting at pos */
+    void DrawOption(const subMenu & menu, size_t i, coords pos) {
+        c_pixel bar_color(menu.barColor);
+
+        if (static_cast<int>(i) == menu.selectedOption) {
+            pos.x = DrawText(pos, menu.barStyle.selected, bar_color);
+        } else {
+            pos.x = DrawText(pos, menu.barStyle.before_option, bar_color);
         }
+
+        c_pixel option_color = (static_cast<int>(i) == menu.selectedOption)
+                                 ? c_pixel(menu.selectedColor)
+                                 : c_pixel(menu.defaultColor);
+
+        if (menu.options[i].overwriteColor_huh)
+            option_color = menu.options[i].overwiteColor;
+
+        pos.x = DrawText(pos, menu.options[i].text, option_color);
+        DrawText(pos, menu.barStyle.after_option, bar_color);
     }
 
-    /* Draw a centered string using a Font, then apply colorFunction to the title bounding box */
-    void DrawStringCenterCords(coords middle, const std::string & str, const Font* font_to_use, std::function<c_pixel(double, double)> colorFunction) {
-        const int nr_chars = static_cast<int>(str.length());
-        int total_length_in_Chars = 0;
-        int title_height_in_Chars = 0;
+    /* Is the grid still what DrawMenu() laid out for this submenu? */
+    bool layoutMatches(const subMenu & menu) const {
+        return layout.valid
+            && layout.menu == currentMenu
+            && layout.width == width && layout.height == height
+            && layout.border == borderEnabled
+            && layout.revision == menu.revision
+            && layout.optionCount == menu.options.size()
+            && layout.name == menu.name
+            && optionBase.sameSize(cells);
+    }
 
-        for (int i = 0; i < nr_chars; ++i) {
-            const Character* pch = (*font_to_use)[str[i]];
-            if (pch == nullptr) continue;
+    /* Retained mode: restore one option row from optionBase and draw it again */
+    void redrawOption(const subMenu & menu, int index) {
+        if (index < 0 || index >= static_cast<int>(layout.optionRows.size())) return;
+        const int y = layout.optionRows[static_cast<size_t>(index)];
+        if (y < 0 || y >= height) return;
 
-            int char_width = 0;
-            int char_height = pch->height;
-            for (int r = 0; r < char_height; ++r)
-                char_width = std::max(char_width, static_cast<int>(pch->data[r].size()));
+        cells.copyRow(optionBase, y);
+        DrawOption(menu, static_cast<size_t>(index), { layout.optionX, y });
+    }
 
-            total_length_in_Chars += char_width;
-            title_height_in_Chars = std::max(title_height_in_Chars, char_height);
+    /*
+     * DrawText(start, utf8, pixel) -> x after the last cell
+     *
+     * Writes a single line of UTF-8 text into the buffer. Tabs advance to the
+     * next multiple of 8 without overwriting, like a terminal tab stop does.
+     */
+    int DrawText(coords start, const std::string & str, c_pixel pixel) {
+        int x = start.x;
+        for (char32_t c : from_utf8(str)) {
+            if (c == U'\t') {
+                x = (x / 8 + 1) * 8;
+                continue;
+            }
+            rawBufferDraw({ x, start.y }, c, pixel);
+            ++x;
         }
+        return x;
+    }
 
-        int absolute_left_x = middle.x - (total_length_in_Chars / 2);
-        int absolute_right_x = middle.x + (total_length_in_Chars / 2);
-        int absolute_top_y = middle.y - (title_height_in_Chars / 2);
+    /* Remove title glyphs by writing space into the same region */
+    void removeTitleFromBuffer() {
+        const titleLayout & title = menuTitle(submenus.at(static_cast<size_t>(currentMenu)));
 
-        int start_x_position = absolute_left_x;
-        for (int i = 0; i < nr_chars; ++i) {
-            const Character* pch = (*font_to_use)[str[i]];
-            if (pch == nullptr) continue;
+        int top_padding = 1;
+        if (borderEnabled) ++top_padding;
+
+        for (const titleLayout::placedGlyph & placed : title.glyphs())
+            DrawOnMask({ title.left() + placed.offset, top_padding }, placed.glyph, U' ');
+    }
 
-            coords top_left_char_corner{ start_x_position, absolute_top_y };
-            int char_width = 0;
-            for (size_t r = 0; r < pch->data.size(); ++r)
-                char_width = std::max(char_width, static_cast<int>(pch->data[r].length()));
+    /* The cached title block of a submenu (one per entry in submenus) */
+    titleBlock & titleBlockFor(const subMenu & menu) {
+        const size_t index = static_cast<size_t>(&menu - submenus.data());
+        if (titleBlocks.size() < submenus.size()) titleBlocks.resize(submenus.size());
+        return titleBlocks[index];
+    }
 
-            start_x_position += char_width;
-            DrawOneChar(top_left_char_corner, pch);
-        }
+    /*
+     * Everything the finished title cells depend on. The color callables
+     * are compared by function address, so this is only meaningful when
+     * titleCacheable() says so.
+     */
+    titleBlock::key titleBlockKey(const subMenu & menu, const titleLayout & title) const {
+        titleBlock::key id;
+        id.layout = title.generation();
+        id.revision = menu.revision;
+        id.width = width;
+        id.height = height;
+        id.border = borderEnabled;
+        id.colored = static_cast<bool>(menu.colorFunction) || static_cast<bool>(menu.colorSpan);
+        const auto* fn = menu.colorFunction.target<c_pixel(*)(double, double)>();
+        id.colorFunction = fn ? *fn : nullptr;
+        const auto* span = menu.colorSpan.target<void(*)(const double*, int, double, c_pixel*)>();
+        id.colorSpan = span ? *span : nullptr;
+        return id;
+    }
+
+    /*
+     * A title block can be reused only when its coloring is known not to
+     * change behind our back: no callable, or plain functions. Any other
+     * callable (a lambda, a functor) may hold state and is re-run per frame.
+     */
+    static bool titleCacheable(const subMenu & menu) {
+        return (!menu.colorFunction || menu.colorFunction.target<c_pixel(*)(double, double)>())
+            && (!menu.colorSpan || menu.colorSpan.target<void(*)(const double*, int, double, c_pixel*)>());
+    }
+
+    /* The submenu's title laid out for the current terminal width */
+    const titleLayout & menuTitle(subMenu & menu) {
+        menu.title.update(menu.name, menu.titleFont, width / 2);
+        return menu.title;
+    }
+
+    /* Draw a glyph into the buffer but replacing glyph pixels with a given mask char */
+    void DrawOnMask(coords start, const Character* pToPrint, char32_t char_to_print) {
+        const Character& toPrint = *pToPrint;
+        const encodedGlyph mask(char_to_print);
+        for (int char_y = 0; char_y < toPrint.data.size(); ++char_y)
+            cells.fillGlyphs(start.x, start.y + char_y, toPrint.data[char_y].length(), mask);
+    }
+
+    /* Draw a centered string using a Font, then apply colorFunction to the title bounding box */
+    void DrawStringCenterCords(coords middle, const std::string & str, const Font* font_to_use, std::function<c_pixel(double, double)> colorFunction) {
+        DrawStringCenterCords(middle, str, font_to_use, spanOf(std::move(colorFunction)));
+    }
+
+    void DrawStringCenterCords(coords middle, const std::string & str, const Font* font_to_use, const colorSpanFunction & colorSpan) {
+        stringLayout.update(str, font_to_use, middle.x);
+        int title_height_in_Chars = stringLayout.height();
+
+        int absolute_left_x = stringLayout.left();
+        int absolute_right_x = stringLayout.right();
+        int absolute_top_y = middle.y - (title_height_in_Chars / 2);
+
+        for (const titleLayout::placedGlyph & placed : stringLayout.glyphs())
+            DrawOneChar({ absolute_left_x + placed.offset, absolute_top_y }, *font_to_use, placed.glyph);
 
         int absolute_bottom_y = absolute_top_y + title_height_in_Chars;
-        for (int row = absolute_top_y; row <= absolute_bottom_y; ++row) {
-            for (int col = absolute_left_x; col <= absolute_right_x; ++col) {
-                double x = static_cast<double>(col - absolute_right_x) / static_cast<double>(absolute_right_x - absolute_left_x);
-                double y = static_cast<double>(row - absolute_top_y) / static_cast<double>(absolute_bottom_y - absolute_top_y);
-                coords pos{ col, row };
-                rawBufferDrawColor(pos, colorFunction(x, y));
-            }
+        DrawColorSpans({ absolute_left_x, absolute_top_y },
+                       { absolute_right_x + 1, absolute_bottom_y + 1 },
+                       { absolute_right_x, absolute_top_y },
+                       absolute_right_x - absolute_left_x,
+                       absolute_bottom_y - absolute_top_y,
+                       colorSpan);
+    }
+
+    /*
+     * DrawColorSpans(from, to, origin, scale_x, scale_y, fn)
+     *
+     * Colors the cells of columns [from.x, to.x) and rows [from.y, to.y),
+     * clipped to the screen, one colorSpanFunction call per row. A cell's
+     * normalized coordinates are (col - origin.x) / scale_x and
+     * (row - origin.y) / scale_y; glyphs are kept.
+     */
+    void DrawColorSpans(coords from, coords to, coords origin, double scale_x, double scale_y,
+                        const colorSpanFunction & fn) {
+        const int x0 = std::max(from.x, 0), x1 = std::min(to.x, width);
+        const int y0 = std::max(from.y, 0), y1 = std::min(to.y, height);
+        if (!fn || x0 >= x1 || y0 >= y1) return;
+
+        const int count = x1 - x0;
+        spanXs.resize(static_cast<size_t>(count));
+        spanColors.resize(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i)
+            spanXs[i] = static_cast<double>(x0 + i - origin.x) / scale_x;
+
+        for (int row = y0; row < y1; ++row) {
+            fn(spanXs.data(), count, static_cast<double>(row - origin.y) / scale_y, spanColors.data());
+            cell * line = cells.row(row) + x0;
+            for (int i = 0; i < count; ++i) line[i].pixel = spanColors[i];
+            cells.markDirty(x0, x1 - 1, row);
         }
     }
 
@@ -3610,6 +5399,37 @@ public:
         }
     }
 
+    /*
+     * Draw one glyph of font from its atlas: one clipped row copy per glyph
+     * row. A glyph that is not font's own is drawn cell by cell instead.
+     */
+    void DrawOneChar(coords start, const Font& font, const Character* pToPrint) {
+        const size_t glyph = font.indexOf(pToPrint);
+        if (glyph == Font::npos) {
+            if (pToPrint) DrawOneChar(start, pToPrint);
+            return;
+        }
+        const fontAtlas& atlas = font.atlas();
+        for (int r = 0; r < atlas.rowCount(glyph); ++r) {
+            const fontAtlas::rowSpan span = atlas.row(glyph, r);
+            cells.blitGlyphs(start.x, start.y + r, span.cells, span.length);
+        }
+    }
+
+    void DrawOneChar(coords start, const Font& font, const Character* pToPrint, color rgb) {
+        const size_t glyph = font.indexOf(pToPrint);
+        if (glyph == Font::npos) {
+            if (pToPrint) DrawOneChar(start, pToPrint, rgb);
+            return;
+        }
+        const fontAtlas& atlas = font.atlas();
+        const c_pixel pixel(rgb);
+        for (int r = 0; r < atlas.rowCount(glyph); ++r) {
+            const fontAtlas::rowSpan span = atlas.row(glyph, r);
+            cells.blitGlyphs(start.x, start.y + r, span.cells, span.length, pixel);
+        }
+    }
+
     /* Draw one glyph and set its foreground color for every glyph cell (uses c_pixel(rgb)) */
     void DrawOneChar(coords start, const Character* pToPrint, color rgb) {
         const Character& toPrint = *pToPrint;
@@ -3626,21 +5446,22 @@ public:
     /* Raw buffer writers (boundary-checked) */
     void rawBufferDrawChar(coords pos, char32_t character) {
         if (pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height) return;
-        buffer[pos.y][pos.x] = character;
-        isChanged[pos.y][pos.x] = true;
+        cells(pos.x, pos.y).setGlyph(character);
+        cells.markDirty(pos.x, pos.y);
     }
 
     void rawBufferDrawColor(coords pos, c_pixel new_color) {
         if (pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height) return;
-        color_buffer[pos.y][pos.x] = new_color;
-        isChanged[pos.y][pos.x] = true;
+        cells(pos.x, pos.y).pixel = new_color;
+        cells.markDirty(pos.x, pos.y);
     }
 
     void rawBufferDraw(coords pos, char32_t character, c_pixel color) {
         if (pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height) return;
-        buffer[pos.y][pos.x] = character;
-        color_buffer[pos.y][pos.x] = color;
-        isChanged[pos.y][pos.x] = true;
+        cell & c = cells(pos.x, pos.y);
+        c.setGlyph(character);
+        c.pixel = color;
+        cells.markDirty(pos.x, pos.y);
     }
 
     /* Placeholder for image printing */
@@ -3648,39 +5469,223 @@ public:
         /* Intentionally left blank: implement as needed */
     }
 
-    /* Event loop (blocking) - simple getch handling (up/down/enter) */
+    /*
+     * Main loop: keys, timers and terminal resizes all arrive through
+     * events, and the menu is redrawn once a batch of them has been
+     * handled - and only if one of them changed something. All queued keys
+     * form one batch, so held-down arrows move the selection several steps
+     * and cost a single frame.
+     */
     void startLoop() {
-        while (!exit) {
-            DrawMenu();
-            int c = 0;
-            switch ((c = getch())) {
-                case KEY_UP:
-                    submenus[currentMenu].decrementOption();
-                    break;
-                case KEY_DOWN:
-                    submenus[currentMenu].incrementOption();
-                    break;
-                case 13:
-                    submenus[currentMenu].CallSelectedOption();
-                    break;
-                default:
-                    std::cout << std::endl << "null" << std::endl;
-                    break;
+        redrawPending = true;
+        events.onKey = [this](int c) { handleKey(c); };
+        events.onResize = [this]() {
+            if (resize()) redrawPending = true;
+        };
+        events.onIdle = [this]() {
+            if (exit) {
+                events.stop();
+                return;
+            }
+            if (redrawPending) {
+                redrawPending = false;
+                DrawMenu();
+            }
+        };
+        if (!exit) events.run();
+    }
+
+    /* Up/down/enter handling for one key of the main loop */
+    void handleKey(int c) {
+        /* keys queued behind the one that exited are dropped */
+        if (exit) return;
+        switch (c) {
+            case InputKeys::Up:
+                submenus[currentMenu].decrementOption();
+                redrawPending = true;
+                break;
+            case InputKeys::Down:
+                submenus[currentMenu].incrementOption();
+                redrawPending = true;
+                break;
+            case 13: {
+                const subMenu& menu = submenus[currentMenu];
+                if (menu.options.empty()) break;
+                /* a copy: the callbacks may switch or change the submenus */
+                const UI_Option option = menu.options[static_cast<size_t>(menu.selectedOption)];
+                if (!option.functions.empty()) {
+                    events.cooked([&option]() { option.Call(); });
+                    /* callbacks may have written to the terminal directly */
+                    invalidateFrontBuffer();
+                }
+                startAsync(option);
+                redrawPending = true;
+                break;
             }
+            default:
+                break;
+        }
+    }
+
+    /*
+     * Hand the option's async callbacks to the worker threads. Each one
+     * posts its completion back to the loop, which runs done and stops the
+     * busy indicator once nothing is outstanding.
+     */
+    void startAsync(const UI_Option& option) {
+        for (const UI_Option::asyncCallback& callback : option.asyncFunctions) {
+            if (!callback.work) continue;
+            setBusy(+1);
+            workers.submit([this, callback]() {
+                callback.work();
+                events.post([this, callback]() {
+                    if (callback.done) {
+                        events.cooked(callback.done);
+                        invalidateFrontBuffer();
+                    }
+                    setBusy(-1);
+                });
+            });
+        }
+    }
+
+    /* Number of async callbacks still running */
+    int busy() const { return busyCount; }
+
+    /*
+     * setWorkerThreads(count)
+     *
+     * How many threads run async option callbacks (workerPool::DEFAULT_THREADS
+     * by default). Call it before the first async callback starts; the
+     * threads are created then and keep their number.
+     */
+    void setWorkerThreads(unsigned count) {
+        workers = workerPool(count);
+    }
+
+    void setBusy(int delta) {
+        const bool wasBusy = busyCount > 0;
+        busyCount = std::max(0, busyCount + delta);
+        if (!wasBusy && busyCount > 0) {
+            busyTimer = addTimer(100, [this]() {
+                ++busyFrame;
+                return true;
+            });
+        } else if (wasBusy && busyCount == 0) {
+            events.removeTimer(busyTimer);
+            /* the spinner covered a composed cell; compose the frame again */
+            invalidateLayout();
+        }
+        redrawPending = true;
+    }
+
+    /*
+     * The busy indicator: a spinner in the bottom-right corner (inside the
+     * border) while async callbacks run. It only ever draws over the frame;
+     * when the last callback is done setBusy() asks for a full compose,
+     * which brings back whatever the spinner covered.
+     */
+    void drawBusyIndicator() {
+        if (busyCount == 0) return;
+        const int inset = borderEnabled ? 2 : 1;
+        const int x = width - inset, y = height - inset;
+        if (x < 0 || y < 0 || x >= cells.width() || y >= cells.height()) return;
+
+        static const char32_t spinner[] = { U'|', U'/', U'-', U'\\' };
+        cell next;
+        next.setGlyph(spinner[busyFrame % 4]);
+        if (cells(x, y) != next) {
+            cells(x, y) = next;
+            cells.markDirty(x, y);
         }
     }
 
+    /* Ask the main loop for a redraw once the current events are handled */
+    void requestRedraw() { redrawPending = true; }
+
+    /*
+     * Run tick every interval_ms from the main loop; the menu is redrawn
+     * afterwards when tick returns true. Returns an id for events.removeTimer.
+     */
+    int addTimer(int interval_ms, std::function<bool()> tick) {
+        return events.addTimer(interval_ms, [this, tick]() {
+            if (tick()) redrawPending = true;
+        });
+    }
+
     /* Public state */
     int width;
     int height;
     bool borderEnabled;
+    bool doubleBuffered;
+    bool synchronizedUpdates;
+    bool retainedMode;
 
     int currentMenu;
     std::vector<subMenu> submenus;
 
-    std::vector<std::vector<char32_t>> buffer;
-    std::vector<std::vector<c_pixel>> color_buffer;
-    std::vector<std::vector<bool>> isChanged;
+    /* Back buffer: what the next frame should look like */
+    cellGrid cells;
+
+    /* Last frame sent to the terminal (double buffering only) */
+    cellGrid front;
+    bool frontValid;
+
+    /* Where frames go (stdout by default) */
+    std::shared_ptr<frameSink> sink;
+
+    /* What the last full DrawMenu() laid out (retained mode) */
+    struct menuLayout {
+        bool valid = false;
+        int menu = -1;
+        int width = 0;
+        int height = 0;
+        bool border = false;
+        unsigned int revision = 0;
+        std::string name;
+        size_t optionCount = 0;
+        int selected = 0;
+        int optionX = 0;
+        std::vector<int> optionRows;
+    };
+    menuLayout layout;
+    cellGrid optionBase;
+
+    /* Last string laid out by DrawStringCenterCords() */
+    titleLayout stringLayout;
+
+    /* Blank-or-bordered starting point of every full DrawMenu() */
+    cellGrid baseLayer;
+    bool baseLayerValid = false;
+    bool baseLayerBorder = false;
+
+    /* Last addGradient(separableGradient) result, reused while size and terms match */
+    struct {
+        bool valid = false;
+        int width = 0;
+        int height = 0;
+        separableGradient gradient;
+        std::vector<double> columns;
+        std::vector<unsigned char> rowBytes;   /* one row per channel, combined before packing */
+        std::vector<color> colors;
+    } gradientCache;
+
+    /* Scratch rows for DrawColorSpans() */
+    std::vector<double> spanXs;
+    std::vector<c_pixel> spanColors;
+
+    /* Finished title cells per submenu, reused while their key matches */
+    std::vector<titleBlock> titleBlocks;
+
+    /* Keys, timers and resizes for startLoop() */
+    eventLoop events;
+    bool redrawPending = false;
+
+    /* Async option callbacks; declared after events so it joins first */
+    workerPool workers;
+    int busyCount = 0;
+    int busyFrame = 0;
+    int busyTimer = 0;
 
     bool exit;
 };
@@ -0,0 +1,68 @@
+/*
+ * busy_indicator_test.cpp
+ *
+ * The async busy spinner must never damage the composed frame: while idle
+ * the cell under it keeps what the menu drew there, and once the last
+ * callback completes the covered cell comes back.
+ *
+ *   g++ -std=c++14 -I.. busy_indicator_test.cpp -o busy_indicator_test -pthread
+ */
+#include <cstdio>
+#include <string>
+#include "menu.h"
+
+struct nullSink : frameSink {
+    void writeOut(const char*, size_t) override {}
+};
+
+static void noop() {}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+/* A 40x30 bordered menu whose options run across the spinner's cell */
+static void setUp(cliMenu& menu, bool retained) {
+    menu.width = 40;
+    menu.height = 30;
+    menu.cells.assign(menu.width, menu.height);
+    menu.borderEnabled = true;
+    menu.setSink(std::make_shared<nullSink>());
+    menu.setDoubleBuffering(true);
+    menu.setRetainedMode(retained);
+
+    subMenu sub("T");
+    for (int i = 0; i < 20; ++i)
+        sub.addOptions({ UI_Option(std::string(40, 'p'), noop) });
+    menu.submenus.push_back(sub);
+}
+
+static void run(bool retained) {
+    cliMenu menu;
+    setUp(menu, retained);
+
+    const int x = menu.width - 2, y = menu.height - 2;
+    menu.DrawMenu();
+    const cell composed = menu.cells(x, y);
+    check(std::string(composed.utf8()) == "p", retained ? "retained: option text under the spinner cell" : "option text under the spinner cell");
+
+    menu.DrawMenu();
+    check(menu.cells(x, y) == composed, retained ? "retained: idle frames keep the cell" : "idle frames keep the cell");
+
+    menu.setBusy(+1);
+    menu.DrawMenu();
+    check(std::string(menu.cells(x, y).utf8()) != "p", retained ? "retained: spinner shows while busy" : "spinner shows while busy");
+
+    menu.setBusy(-1);
+    menu.DrawMenu();
+    check(menu.cells(x, y) == composed, retained ? "retained: cell restored after the last completion" : "cell restored after the last completion");
+}
+
+int main() {
+    run(false);
+    run(true);
+    return failures ? 1 : 0;
+}
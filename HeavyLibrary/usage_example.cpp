@@ -10,13 +10,6 @@ cliMenu menu;
 
 using namespace std;
 
-c_pixel GOLDRED(double x, double y){
-    color new_color = HSLtoRGB(x*y * 30, 1, 0.5);
-    c_pixel result = c_pixel(new_color);
-
-    return result;
-}
-
 void gamble(){
     srand(time(0));
     //Clear Buffer
@@ -54,7 +47,6 @@ void gamble(){
     for(int frame = 0; frame < numbers_to_shuffle[2]; frame++){
         //Clear Buffer
         //menu.init();
-        cout << ERASE_CONSOLE;
         cout << "\a";
 
         //Logic ...... no logic it is gambling
@@ -65,7 +57,8 @@ void gamble(){
 
             coords pos{displacement * (i+1), middle_y};
 
-            const Character* pch = (fonts[AvailableFonts::Mono12])[ch];
+            const Font& font = fonts[AvailableFonts::Mono12];
+            const Character* pch = font[ch];
             if(!pch)
                 continue;
 
@@ -73,7 +66,7 @@ void gamble(){
             if(frame >= numbers_to_shuffle[i]-2)
                 col = color{255, 215, 0};
 
-            menu.DrawOneChar(pos, pch, col);
+            menu.DrawOneChar(pos, font, pch, col);
         }
 
         for(int i = 0; i < menu.width; i++){
@@ -130,9 +123,9 @@ void gamble(){
 
     coords middle{menu.width/2, menu.height/2};
     if(hasWon){
-        menu.DrawStringCenterCords(middle, congrats, font, rainbowUV);
+        menu.DrawStringCenterCords(middle, congrats, font, rainbowUVSpan);
     }else{
-        menu.DrawStringCenterCords(middle, congrats, font, GOLDRED);
+        menu.DrawStringCenterCords(middle, congrats, font, goldRedUVSpan);
     }
     menu.printBuffer();
 
@@ -141,12 +134,6 @@ void gamble(){
 }
 
 
-void HelpUserSetScreenSize(){
-    cout << "Resize Screen and font size, menu will detect them but will NOT update if console changes. \n Press enter after you are done.";
-    getch();
-    menu.init();
-}
-
 void goToGame2(){
     menu.SelectSubMenu("PLAY");
 }
@@ -172,7 +159,7 @@ void setari(){
     }
     cout << "-------------------------------------\n";
 
-    getch();
+    readKey();
 }
 
 void returnToMainMenu(){
@@ -181,12 +168,14 @@ void returnToMainMenu(){
 
 int main() {
 
-    HelpUserSetScreenSize();
-
+    /* console resizes are picked up by startLoop() */
+    menu.setDoubleBuffering(true);
+    menu.setRetainedMode(true);
+    menu.setSynchronizedUpdates(SynchronizedUpdates::Auto);
     menu.addBorder();
 
     subMenu welcome(">LASVEGAS<");
-    welcome.colorFunction = rainbowUV;
+    welcome.setColorSpanFunction(rainbowUVSpan);
 
     UI_Option exit_option("Exit", exit);
     exit_option.overwriteColor_huh = true;
@@ -203,7 +192,7 @@ int main() {
 
 
     subMenu play("PLAY");
-    play.colorFunction = GOLDRED;
+    play.setColorSpanFunction(goldRedUVSpan);
     play.addOptions({
         UI_Option("Gamble", gamble),
         UI_Option("Return to main menu", returnToMainMenu)
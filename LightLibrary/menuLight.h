@@ -9,13 +9,39 @@
 #include <locale>
 #include <codecvt>
 #include <functional>
-#include <conio.h>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
 
 #ifdef _WIN32
     #include <windows.h>
+    #include <conio.h>
+    #include <io.h>
 #else
     #include <sys/ioctl.h>
     #include <unistd.h>
+    #include <cerrno>
+    #include <csignal>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <termios.h>
+    #ifdef __linux__
+        #include <sys/timerfd.h>
+    #endif
+#endif
+
+/* SIMD kernels for the batch HSLtoRGB, chosen by the compiler's target flags */
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define MENU_HSL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define MENU_HSL_SSE2
 #endif
 
 #ifdef _WIN32
@@ -49,6 +75,7 @@
 
 #define ERASE_CONSOLE "\033c"
 
+/* DOS scan codes for the arrows, as a second _getch() returns them; see InputKeys */
 #define KEY_UP 72
 #define KEY_DOWN 80
 
@@ -124,6 +151,936 @@ struct coords {
     int y;
 };
 
+/* --------------------------------------------------------------------------
+   escape - allocation-free escape sequence encoder
+   -------------------------------------------------------------------------- */
+/*
+ * All writers take a caller-supplied output pointer, write at it and return
+ * the position after the last byte written. Nothing allocates; decimal
+ * arguments 0..255 come from a table built at compile time.
+ */
+namespace escape {
+    struct decimalTable {
+        char digits[256][3];
+        unsigned char length[256];
+    };
+
+    constexpr decimalTable makeDecimalTable() {
+        decimalTable table{};
+        for (int v = 0; v < 256; ++v) {
+            int n = 0;
+            if (v >= 100) table.digits[v][n++] = static_cast<char>('0' + v / 100);
+            if (v >= 10)  table.digits[v][n++] = static_cast<char>('0' + (v / 10) % 10);
+            table.digits[v][n++] = static_cast<char>('0' + v % 10);
+            table.length[v] = static_cast<unsigned char>(n);
+        }
+        return table;
+    }
+
+    constexpr decimalTable decimals = makeDecimalTable();
+
+    /* Length of ESC[38;2;255;255;255m */
+    constexpr size_t MAX_COLOR_LENGTH = 19;
+
+    inline char* put(char* out, const char* text) {
+        while (*text) *out++ = *text++;
+        return out;
+    }
+
+    inline char* putByte(char* out, unsigned char v) {
+        const char* digits = decimals.digits[v];
+        for (unsigned char i = 0; i < decimals.length[v]; ++i) *out++ = digits[i];
+        return out;
+    }
+
+    /* Complete foreground color sequence */
+    inline char* foreground(char* out, const Color& c) {
+        out = put(out, ESC_COLOR_CODE FOREGROUND_SEQUENCE);
+        out = putByte(out, c.R());
+        *out++ = ';';
+        out = putByte(out, c.G());
+        *out++ = ';';
+        out = putByte(out, c.B());
+        return put(out, CLOSE_SEQUENCE);
+    }
+
+    /* Append a foreground color sequence to a string */
+    inline void appendForeground(std::string& str, const Color& c) {
+        char seq[MAX_COLOR_LENGTH];
+        str.append(seq, static_cast<size_t>(foreground(seq, c) - seq));
+    }
+
+    /* Longest cursor move: ESC[<10 digits>;<10 digits>H */
+    constexpr size_t MAX_CURSOR_LENGTH = 32;
+
+    inline char* putInt(char* out, int v) {
+        if (v >= 0 && v < 256) return putByte(out, static_cast<unsigned char>(v));
+
+        char reversed[12];
+        int n = 0;
+        unsigned int u = v < 0 ? 0u - static_cast<unsigned int>(v) : static_cast<unsigned int>(v);
+        if (v < 0) *out++ = '-';
+        do { reversed[n++] = static_cast<char>('0' + u % 10); u /= 10; } while (u);
+        while (n) *out++ = reversed[--n];
+        return out;
+    }
+
+    /* Absolute cursor move, 0-based x/y (same convention as cursor()) */
+    inline char* cursorTo(char* out, int x, int y) {
+        out = put(out, START_SEQUENCE);
+        out = putInt(out, y + 1);
+        *out++ = ';';
+        out = putInt(out, x + 1);
+        *out++ = 'H';
+        return out;
+    }
+
+    inline void appendCursor(std::string& str, int x, int y) {
+        char seq[MAX_CURSOR_LENGTH];
+        str.append(seq, static_cast<size_t>(cursorTo(seq, x, y) - seq));
+    }
+}
+
+/* --------------------------------------------------------------------------
+   frameSink - collects a frame and writes it to a file descriptor at once
+   -------------------------------------------------------------------------- */
+/*
+ * Frames are appended to a reusable buffer (its capacity survives flushes)
+ * and flush() hands the whole thing to writeOut() in one call, which by
+ * default is a single write() to fd (looping only on partial writes).
+ * Derive and override writeOut() to send frames somewhere else.
+ */
+class frameSink {
+public:
+    explicit frameSink(int fd = 2 /* stderr, unbuffered like std::cerr */) : fd_(fd) {}
+    virtual ~frameSink() = default;
+
+    std::string& frame() { return frame_; }
+
+    void append(const char* data, size_t size) { frame_.append(data, size); }
+    void append(const std::string& str) { frame_ += str; }
+
+    void flush() {
+        if (!frame_.empty()) writeOut(frame_.data(), frame_.size());
+        frame_.clear();
+    }
+
+    int fd() const { return fd_; }
+    void setFd(int fd) { fd_ = fd; }
+
+protected:
+    virtual void writeOut(const char* data, size_t size) {
+        /* Keep ordering with anything still sitting in the iostream buffers */
+        std::cout.flush();
+
+        while (size > 0) {
+            #ifdef _WIN32
+                int written = _write(fd_, data, static_cast<unsigned int>(size));
+                if (written <= 0) return;
+            #else
+                ssize_t written = ::write(fd_, data, size);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) return;
+            #endif
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+private:
+    std::string frame_;
+    int fd_;
+};
+
+/* --------------------------------------------------------------------------
+   Keyboard input - raw terminal mode and escape sequence decoding
+   -------------------------------------------------------------------------- */
+/*
+ * InputKeys::EnumKey
+ *
+ * Codes for keys that have no character of their own. They start above the
+ * Unicode range, so a key handler can tell them apart from plain bytes.
+ */
+namespace InputKeys {
+    enum EnumKey {
+        Up = 0x110000,
+        Down,
+        Left,
+        Right,
+        Home,
+        End,
+        Insert,
+        Delete,
+        PageUp,
+        PageDown,
+        F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+        Paste /* bracketed paste; the text travels in keyEvent::text */
+    };
+}
+
+/* One decoded key: a byte, or an InputKeys code */
+struct keyEvent {
+    int key;
+    std::string text;
+};
+
+/*
+ * keyDecoder
+ *
+ * Turns the bytes sent by a VT/xterm-style terminal into keys. CSI and SS3
+ * escape sequences are looked up in a table (a modifier parameter such as
+ * the 5 in ESC[1;5A is ignored, unknown sequences are dropped), anything
+ * else is passed on byte by byte. A sequence may be split across feed()
+ * calls: pending() then reports it, and the caller flush()es it as plain
+ * bytes when nothing followed within ESCAPE_DELAY_MS - which is how a lone
+ * Esc press arrives. Text between ESC[200~ and ESC[201~ becomes a single
+ * InputKeys::Paste event.
+ */
+class keyDecoder {
+public:
+    enum : int { ESCAPE_DELAY_MS = 25 };
+
+    keyDecoder() : pasting_(false) {}
+
+    void feed(const char* data, size_t size, std::vector<keyEvent>& out) {
+        for (size_t i = 0; i < size; ++i)
+            feedByte(data[i], out);
+    }
+
+    bool pending() const { return !sequence_.empty(); }
+
+    /* Deliver an unfinished sequence as the bytes it consists of */
+    void flush(std::vector<keyEvent>& out) {
+        for (char c : sequence_)
+            out.push_back({ static_cast<unsigned char>(c), std::string() });
+        sequence_.clear();
+    }
+
+    /* The key for a scan code that follows a 0 or 224 from _getch(); 0 if none */
+    static int fromScanCode(int scan) {
+        switch (scan) {
+            case 72: return InputKeys::Up;
+            case 80: return InputKeys::Down;
+            case 75: return InputKeys::Left;
+            case 77: return InputKeys::Right;
+            case 71: return InputKeys::Home;
+            case 79: return InputKeys::End;
+            case 82: return InputKeys::Insert;
+            case 83: return InputKeys::Delete;
+            case 73: return InputKeys::PageUp;
+            case 81: return InputKeys::PageDown;
+            case 133: return InputKeys::F11;
+            case 134: return InputKeys::F12;
+            default:
+                return scan >= 59 && scan <= 68 ? InputKeys::F1 + (scan - 59) : 0;
+        }
+    }
+
+private:
+    struct sequenceKey {
+        const char* sequence;
+        int key;
+    };
+
+    static const sequenceKey* table(size_t& count) {
+        static const sequenceKey keys[] = {
+            { "\033[A", InputKeys::Up },      { "\033OA", InputKeys::Up },
+            { "\033[B", InputKeys::Down },    { "\033OB", InputKeys::Down },
+            { "\033[C", InputKeys::Right },   { "\033OC", InputKeys::Right },
+            { "\033[D", InputKeys::Left },    { "\033OD", InputKeys::Left },
+            { "\033[H", InputKeys::Home },    { "\033OH", InputKeys::Home },
+            { "\033[F", InputKeys::End },     { "\033OF", InputKeys::End },
+            { "\033[1~", InputKeys::Home },   { "\033[7~", InputKeys::Home },
+            { "\033[4~", InputKeys::End },    { "\033[8~", InputKeys::End },
+            { "\033[2~", InputKeys::Insert }, { "\033[3~", InputKeys::Delete },
+            { "\033[5~", InputKeys::PageUp }, { "\033[6~", InputKeys::PageDown },
+            { "\033OP", InputKeys::F1 },      { "\033[11~", InputKeys::F1 },  { "\033[[A", InputKeys::F1 },
+            { "\033OQ", InputKeys::F2 },      { "\033[12~", InputKeys::F2 },  { "\033[[B", InputKeys::F2 },
+            { "\033OR", InputKeys::F3 },      { "\033[13~", InputKeys::F3 },  { "\033[[C", InputKeys::F3 },
+            { "\033OS", InputKeys::F4 },      { "\033[14~", InputKeys::F4 },  { "\033[[D", InputKeys::F4 },
+            { "\033[15~", InputKeys::F5 },    { "\033[[E", InputKeys::F5 },
+            { "\033[17~", InputKeys::F6 },    { "\033[18~", InputKeys::F7 },
+            { "\033[19~", InputKeys::F8 },    { "\033[20~", InputKeys::F9 },
+            { "\033[21~", InputKeys::F10 },   { "\033[23~", InputKeys::F11 },
+            { "\033[24~", InputKeys::F12 },
+        };
+        count = sizeof(keys) / sizeof(keys[0]);
+        return keys;
+    }
+
+    void feedByte(char c, std::vector<keyEvent>& out) {
+        if (pasting_) {
+            static const char end[] = "\033[201~";
+            const size_t endLength = sizeof(end) - 1;
+            paste_ += c;
+            if (paste_.size() >= endLength && paste_.compare(paste_.size() - endLength, endLength, end) == 0) {
+                paste_.resize(paste_.size() - endLength);
+                out.push_back({ InputKeys::Paste, std::move(paste_) });
+                paste_.clear();
+                pasting_ = false;
+            }
+            return;
+        }
+
+        if (sequence_.empty()) {
+            if (c == '\033') sequence_ += c;
+            else out.push_back({ static_cast<unsigned char>(c), std::string() });
+            return;
+        }
+
+        const unsigned char u = static_cast<unsigned char>(c);
+        if (sequence_.size() == 1) {
+            if (c == '[' || c == 'O') {
+                sequence_ += c;
+                return;
+            }
+            /* Esc followed by anything else: two separate keys */
+            flush(out);
+            feedByte(c, out);
+            return;
+        }
+
+        if (sequence_[1] == 'O') {          /* SS3: ESC O <final> */
+            sequence_ += c;
+            finish(out);
+        } else if (sequence_.size() == 2 && c == '[') {
+            sequence_ += c;                 /* Linux console F1-F5: ESC [ [ <A-E> */
+        } else if (sequence_.size() == 3 && sequence_[2] == '[') {
+            sequence_ += c;
+            finish(out);
+        } else if (u >= 0x40 && u <= 0x7E) {
+            sequence_ += c;                 /* CSI final byte */
+            finish(out);
+        } else if (u >= 0x20 && u <= 0x3F && sequence_.size() < 16) {
+            sequence_ += c;                 /* CSI parameter / intermediate byte */
+        } else {
+            /* not a sequence after all */
+            flush(out);
+            feedByte(c, out);
+        }
+    }
+
+    void finish(std::vector<keyEvent>& out) {
+        std::string key;
+        key.swap(sequence_);
+
+        /* ESC[<n>;<modifiers><final> -> ESC[<n><final>, and ESC[1<final> -> ESC[<final> */
+        const size_t separator = key.find(';');
+        if (separator != std::string::npos)
+            key.erase(separator, key.size() - 1 - separator);
+        if (key.size() == 4 && key[2] == '1' && key[3] != '~')
+            key.erase(2, 1);
+
+        if (key == "\033[200~") {
+            pasting_ = true;
+            return;
+        }
+
+        size_t count = 0;
+        const sequenceKey* keys = table(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (key == keys[i].sequence) {
+                out.push_back({ keys[i].key, std::string() });
+                return;
+            }
+        }
+    }
+
+    std::string sequence_;
+    std::string paste_;
+    bool pasting_;
+};
+
+/*
+ * rawTerminal
+ *
+ * While entered, stdin is non-canonical and does not echo, Enter arrives
+ * as 13 and pastes are bracketed; leave() (or the destructor) puts back
+ * what was there before. Does nothing when stdin is not a terminal, and
+ * on Windows, where _getch() already reads single keys.
+ */
+class rawTerminal {
+public:
+    rawTerminal() : active_(false) {}
+    ~rawTerminal() { leave(); }
+
+    rawTerminal(const rawTerminal&) = delete;
+    rawTerminal& operator=(const rawTerminal&) = delete;
+
+    bool active() const { return active_; }
+
+    void enter() {
+        #ifndef _WIN32
+            if (active_ || !isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_) != 0) return;
+            termios raw = saved_;
+            raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+            raw.c_iflag &= ~static_cast<tcflag_t>(ICRNL);
+            raw.c_cc[VMIN] = 1;
+            raw.c_cc[VTIME] = 0;
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+            control("\033[?2004h");
+            active_ = true;
+        #endif
+    }
+
+    void leave() {
+        #ifndef _WIN32
+            if (!active_) return;
+            control("\033[?2004l");
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved_);
+            active_ = false;
+        #endif
+    }
+
+private:
+    #ifndef _WIN32
+        /* Mode switches go to whichever of stdout/stderr is the terminal */
+        static void control(const char* sequence) {
+            const int fd = isatty(STDOUT_FILENO) ? STDOUT_FILENO : STDERR_FILENO;
+            if (!isatty(fd)) return;
+            std::cout.flush();
+            ssize_t written = ::write(fd, sequence, std::strlen(sequence));
+            (void)written;
+        }
+
+        termios saved_;
+    #endif
+    bool active_;
+};
+
+/*
+ * readKey()
+ *
+ * Wait for one key and return it: a byte, or an InputKeys code. Use it
+ * where getch() was used to wait for a key press outside startLoop(); any
+ * further keys that arrived in the same burst are discarded.
+ */
+inline int readKey() {
+    #ifdef _WIN32
+        const int c = _getch();
+        if (c == 0 || c == 224) {
+            const int scan = _getch();
+            const int key = keyDecoder::fromScanCode(scan);
+            return key ? key : scan;
+        }
+        return c;
+    #else
+        rawTerminal raw;
+        raw.enter();
+        keyDecoder decoder;
+        std::vector<keyEvent> keys;
+        char bytes[256];
+        while (keys.empty()) {
+            if (decoder.pending()) {
+                pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+                if (poll(&fd, 1, keyDecoder::ESCAPE_DELAY_MS) == 0) {
+                    decoder.flush(keys);
+                    continue;
+                }
+            }
+            const ssize_t got = ::read(STDIN_FILENO, bytes, sizeof(bytes));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return -1;
+            decoder.feed(bytes, static_cast<size_t>(got), keys);
+        }
+        return keys.front().key;
+    #endif
+}
+
+/* --------------------------------------------------------------------------
+   eventLoop - waits for keys, timers and resizes in one place
+   -------------------------------------------------------------------------- */
+/*
+ * run() sleeps in poll() on stdin, a timerfd armed for the earliest timer
+ * (Linux; elsewhere the poll timeout does the same job), a self-pipe
+ * written by the SIGWINCH handler and a wake pipe for post(), and
+ * dispatches from the calling thread:
+ *
+ * - onKey(key) for every key decoded from stdin (keyDecoder), onPaste(text)
+ *   for a bracketed paste,
+ * - the callbacks of the timers that are due (addTimer),
+ * - onResize() after the terminal window changed size,
+ * - functions handed to post() by other threads,
+ * - onIdle() once a batch of events has been handled; redraw there.
+ *
+ * Input is read in bulk: each wakeup drains whatever stdin has queued, so
+ * a burst of key repeats costs one onIdle() redraw, not one per key.
+ * While run() is active the terminal is in raw mode (rawTerminal);
+ * cooked() lends the normal mode back to code that reads lines or writes
+ * to the terminal itself. On Windows the loop waits on the console input
+ * handle and a wake event, reads keys with _getch() and compares the
+ * console size to notice resizes.
+ *
+ * A copy starts out empty (no callbacks, timers or posted functions):
+ * those usually point back at the object that owns the loop.
+ */
+class eventLoop {
+public:
+    typedef std::chrono::steady_clock clock;
+
+    eventLoop() : running_(false), nextTimerId_(0), posted_(nullptr) { openWake(); }
+    eventLoop(const eventLoop&) : eventLoop() {}
+    eventLoop& operator=(const eventLoop&) { return *this; }
+
+    ~eventLoop() {
+        runPosted(false);
+        #ifdef _WIN32
+            if (wake_) CloseHandle(wake_);
+        #else
+            for (int fd : wake_)
+                if (fd >= 0) close(fd);
+        #endif
+    }
+
+    std::function<void(int)> onKey;
+    std::function<void(const std::string&)> onPaste;
+    std::function<void()> onResize;
+    std::function<void()> onIdle;
+
+    /* Call tick every interval_ms until removeTimer(id); returns the id */
+    int addTimer(int interval_ms, std::function<void()> tick) {
+        timer t;
+        t.id = ++nextTimerId_;
+        t.interval = std::chrono::milliseconds((std::max)(interval_ms, 1));
+        t.next = clock::now() + t.interval;
+        t.tick = std::move(tick);
+        timers_.push_back(std::move(t));
+        return nextTimerId_;
+    }
+
+    void removeTimer(int id) {
+        timers_.erase(std::remove_if(timers_.begin(), timers_.end(),
+                                     [id](const timer& t) { return t.id == id; }),
+                      timers_.end());
+    }
+
+    bool running() const { return running_; }
+    void stop() { running_ = false; }
+
+    /*
+     * Queue fn to run on the loop's thread and wake the loop; safe to call
+     * from any thread. The queue is a lock-free stack that the loop takes
+     * over in one exchange and replays oldest first.
+     */
+    void post(std::function<void()> fn) {
+        postedTask* task = new postedTask{ std::move(fn), posted_.load(std::memory_order_relaxed) };
+        while (!posted_.compare_exchange_weak(task->next, task,
+                                              std::memory_order_release, std::memory_order_relaxed)) {}
+        #ifdef _WIN32
+            if (wake_) SetEvent(wake_);
+        #else
+            if (wake_[1] >= 0) {
+                const char byte = 0;
+                ssize_t written = ::write(wake_[1], &byte, 1);   /* a full pipe already wakes */
+                (void)written;
+            }
+        #endif
+    }
+
+    /* Run fn with the terminal back in the mode it had before run() */
+    template <class Fn>
+    void cooked(Fn fn) {
+        const bool wasRaw = terminal_.active();
+        if (wasRaw) terminal_.leave();
+        fn();
+        if (wasRaw) terminal_.enter();
+    }
+
+    void run() {
+        running_ = true;
+        #ifdef _WIN32
+            runWindows();
+        #else
+            runPosix();
+        #endif
+        running_ = false;
+    }
+
+private:
+    enum : int { MAX_READS_PER_BATCH = 16 };
+
+    struct timer {
+        int id;
+        clock::duration interval;
+        clock::time_point next;
+        std::function<void()> tick;
+    };
+
+    struct postedTask {
+        std::function<void()> fn;
+        postedTask* next;
+    };
+
+    void openWake() {
+        #ifdef _WIN32
+            wake_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        #else
+            wake_[0] = wake_[1] = -1;
+            if (pipe(wake_) != 0) return;
+            for (int fd : wake_) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        #endif
+    }
+
+    /* Take everything post()ed so far and run it in posting order (or just free it) */
+    void runPosted(bool execute = true) {
+        postedTask* task = posted_.exchange(nullptr, std::memory_order_acquire);
+        postedTask* ordered = nullptr;
+        while (task) {
+            postedTask* next = task->next;
+            task->next = ordered;
+            ordered = task;
+            task = next;
+        }
+        while (ordered) {
+            std::unique_ptr<postedTask> current(ordered);
+            ordered = ordered->next;
+            if (execute && current->fn) current->fn();
+        }
+    }
+
+    void dispatch(std::vector<keyEvent>& keys) {
+        for (size_t i = 0; i < keys.size() && running_; ++i) {
+            if (keys[i].key == InputKeys::Paste) {
+                if (onPaste) onPaste(keys[i].text);
+            } else if (onKey) {
+                onKey(keys[i].key);
+            }
+        }
+        keys.clear();
+    }
+
+    /* Fire every due timer once; a timer that fell behind skips the missed ticks */
+    void runDueTimers() {
+        const clock::time_point now = clock::now();
+        for (size_t i = 0; i < timers_.size() && running_; ++i) {
+            timer& t = timers_[i];
+            if (t.next > now) continue;
+            t.next += t.interval;
+            if (t.next <= now) t.next = now + t.interval;
+            /* copied: the callback may add or remove timers */
+            std::function<void()> tick = t.tick;
+            tick();
+        }
+    }
+
+    bool nextDeadline(clock::time_point& deadline) const {
+        if (timers_.empty()) return false;
+        deadline = timers_[0].next;
+        for (const timer& t : timers_)
+            deadline = (std::min)(deadline, t.next);
+        return true;
+    }
+
+    /* Milliseconds until the earliest timer, -1 without timers */
+    int timeoutMs() const {
+        clock::time_point deadline;
+        if (!nextDeadline(deadline)) return -1;
+        const clock::duration left = deadline - clock::now();
+        if (left <= clock::duration::zero()) return 0;
+        std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(left);
+        if (ms < left) ++ms;    /* round up: waking early would spin */
+        return static_cast<int>(ms.count());
+    }
+
+#ifdef _WIN32
+    static bool consoleSize(int& w, int& h) {
+        CONSOLE_SCREEN_BUFFER_INFO csbi;
+        if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return false;
+        w = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+        h = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+        return true;
+    }
+
+    void runWindows() {
+        HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+        int w = 0, h = 0;
+        consoleSize(w, h);
+
+        if (onIdle) onIdle();
+        while (running_) {
+            /* the console has no resize signal for us; look at least every 100 ms */
+            int timeout = timeoutMs();
+            if (timeout < 0 || timeout > 100) timeout = 100;
+
+            HANDLE handles[2] = { input, wake_ };
+            const DWORD waited = WaitForMultipleObjects(wake_ ? 2 : 1, handles, FALSE, static_cast<DWORD>(timeout));
+            if (waited == WAIT_OBJECT_0) {
+                /* mouse, focus and key-up records also signal the handle; drop them */
+                INPUT_RECORD record;
+                DWORD count = 0;
+                while (PeekConsoleInput(input, &record, 1, &count) && count > 0 &&
+                       !(record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown))
+                    ReadConsoleInput(input, &record, 1, &count);
+
+                while (_kbhit()) {
+                    const int c = _getch();
+                    const int key = (c == 0 || c == 224) ? keyDecoder::fromScanCode(_getch()) : c;
+                    if (key) keys_.push_back({ key, std::string() });
+                }
+                dispatch(keys_);
+            }
+
+            int nw = 0, nh = 0;
+            if (running_ && consoleSize(nw, nh) && (nw != w || nh != h)) {
+                w = nw;
+                h = nh;
+                if (onResize) onResize();
+            }
+
+            if (running_) runPosted();
+            if (running_) runDueTimers();
+            if (running_ && onIdle) onIdle();
+        }
+    }
+#else
+    /* Self-pipe for SIGWINCH; created once, shared by every loop */
+    static int* resizePipe() {
+        static int fds[2] = { -1, -1 };
+        return fds;
+    }
+
+    static void onWinch(int) {
+        const int savedErrno = errno;
+        const char byte = 0;
+        ssize_t written = ::write(resizePipe()[1], &byte, 1);
+        (void)written;
+        errno = savedErrno;
+    }
+
+    static bool openResizePipe() {
+        int* fds = resizePipe();
+        if (fds[0] >= 0) return true;
+        if (pipe(fds) != 0) return false;
+        for (int i = 0; i < 2; ++i) {
+            fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        }
+        return true;
+    }
+
+    /*
+     * Decode everything stdin has queued, so that held-down keys are all
+     * applied before the next onIdle() redraw. Bounded per batch so a flood
+     * of input cannot hold the redraw back; returns false at end of file.
+     */
+    bool drainInput() {
+        char bytes[256];
+        for (int reads = 0; reads < MAX_READS_PER_BATCH; ++reads) {
+            const ssize_t got = ::read(STDIN_FILENO, bytes, sizeof(bytes));
+            if (got < 0 && errno == EINTR) continue;
+            if (got == 0) return false;
+            if (got < 0) break;
+            decoder_.feed(bytes, static_cast<size_t>(got), keys_);
+
+            pollfd more = { STDIN_FILENO, POLLIN, 0 };
+            if (poll(&more, 1, 0) <= 0 || !(more.revents & POLLIN)) break;
+        }
+        return true;
+    }
+
+#ifdef __linux__
+    /* Arm (or disarm) the timerfd for the earliest timer, as an absolute time */
+    void armTimerFd(int fd) const {
+        itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        clock::time_point deadline;
+        if (nextDeadline(deadline)) {
+            /* steady_clock is CLOCK_MONOTONIC; a zero it_value would disarm */
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            if (ns <= 0) ns = 1;
+            spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000LL);
+            spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000LL);
+        }
+        timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+#endif
+
+    void runPosix() {
+        const bool resizeWatched = openResizePipe();
+        struct sigaction action, previous;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = onWinch;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        if (resizeWatched) sigaction(SIGWINCH, &action, &previous);
+
+        #ifdef __linux__
+            const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        #else
+            const int timerFd = -1;
+        #endif
+
+        terminal_.enter();
+        if (onIdle) onIdle();
+
+        while (running_) {
+            pollfd fds[4];
+            nfds_t count = 0;
+            fds[count++] = { STDIN_FILENO, POLLIN, 0 };
+            fds[count++] = { resizePipe()[0], POLLIN, 0 };
+            fds[count++] = { wake_[0], POLLIN, 0 };
+
+            int timeout = -1;
+            #ifdef __linux__
+                if (timerFd >= 0) {
+                    armTimerFd(timerFd);
+                    fds[count++] = { timerFd, POLLIN, 0 };
+                } else {
+                    timeout = timeoutMs();
+                }
+            #else
+                timeout = timeoutMs();
+            #endif
+            /* give an unfinished escape sequence a moment to complete */
+            if (decoder_.pending() && (timeout < 0 || timeout > keyDecoder::ESCAPE_DELAY_MS))
+                timeout = keyDecoder::ESCAPE_DELAY_MS;
+
+            const int ready = poll(fds, count, timeout);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+
+            if (fds[1].revents & POLLIN) {
+                char drain[64];
+                while (::read(fds[1].fd, drain, sizeof(drain)) > 0) {}
+                if (onResize) onResize();
+            }
+
+            if (running_ && (fds[0].revents & POLLIN)) {
+                if (!drainInput()) running_ = false;
+                dispatch(keys_);
+                if (decoder_.pending()) escapeStart_ = clock::now();
+            } else if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                /* stdin is gone; nothing can drive the loop any more */
+                running_ = false;
+            } else if (decoder_.pending() &&
+                       clock::now() - escapeStart_ >= std::chrono::milliseconds(keyDecoder::ESCAPE_DELAY_MS)) {
+                /* nothing followed the escape: it was a key of its own */
+                decoder_.flush(keys_);
+                dispatch(keys_);
+            }
+
+            if (fds[2].revents & POLLIN) {
+                char drain[64];
+                while (::read(fds[2].fd, drain, sizeof(drain)) > 0) {}
+            }
+            /* also picks up tasks posted before run() started */
+            if (running_) runPosted();
+
+            #ifdef __linux__
+                if (count > 3 && (fds[3].revents & POLLIN)) {
+                    uint64_t expirations = 0;
+                    ssize_t got = ::read(timerFd, &expirations, sizeof(expirations));
+                    (void)got;
+                }
+            #endif
+
+            if (running_) runDueTimers();
+            if (running_ && onIdle) onIdle();
+        }
+
+        terminal_.leave();
+        if (timerFd >= 0) close(timerFd);
+        if (resizeWatched) sigaction(SIGWINCH, &previous, nullptr);
+    }
+#endif
+
+    bool running_;
+    int nextTimerId_;
+    std::vector<timer> timers_;
+    std::atomic<postedTask*> posted_;
+    #ifdef _WIN32
+        HANDLE wake_;
+    #else
+        int wake_[2];
+    #endif
+    rawTerminal terminal_;
+    keyDecoder decoder_;
+    clock::time_point escapeStart_;
+    std::vector<keyEvent> keys_;
+};
+
+/* --------------------------------------------------------------------------
+   workerPool - background threads for slow option callbacks
+   -------------------------------------------------------------------------- */
+/*
+ * Jobs are queued under a mutex and taken by a fixed set of threads
+ * (DEFAULT_THREADS unless the constructor says otherwise) that start on
+ * the first submit(), so menus that never go async never spawn any. Menu
+ * callbacks mostly wait on I/O, so the count does not follow the core
+ * count. The destructor lets the running jobs finish, drops the queued
+ * ones and joins. Like eventLoop, a copy or assignment takes over only
+ * the thread count, not jobs or threads.
+ */
+class workerPool {
+public:
+    enum : unsigned { DEFAULT_THREADS = 2 };
+
+    explicit workerPool(unsigned threads = DEFAULT_THREADS)
+        : threads_((std::max)(threads, 1u)), stopping_(false) {}
+    workerPool(const workerPool& other) : threads_(other.threads_), stopping_(false) {}
+
+    /* Takes effect when the threads start, i.e. not once they are running */
+    workerPool& operator=(const workerPool& other) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_ = other.threads_;
+        return *this;
+    }
+
+    unsigned threads() const { return threads_; }
+
+    ~workerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            jobs_.clear();
+        }
+        ready_.notify_all();
+        for (std::thread& worker : workers_)
+            worker.join();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (workers_.empty()) start();
+            jobs_.push_back(std::move(job));
+        }
+        ready_.notify_one();
+    }
+
+private:
+    void start() {
+        for (unsigned i = 0; i < threads_; ++i)
+            workers_.emplace_back([this]() { work(); });
+    }
+
+    void work() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+                if (stopping_) return;
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+
+    unsigned threads_;
+    bool stopping_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> jobs_;
+    std::vector<std::thread> workers_;
+};
+
 namespace AvailableAlignments{
     enum EnumAlignment{
         LEFT,
@@ -132,23 +1089,72 @@ namespace AvailableAlignments{
     };
 }
 
+/* --------------------------------------------------------------------------
+   gradientRamp - a one-coordinate gradient sampled into a lookup table
+   -------------------------------------------------------------------------- */
+/*
+ * gradientRamp
+ *
+ * Entry i of sample(size) is the function's color at x = i / size. The
+ * table is rebuilt only when a different size is asked for or the
+ * function is replaced, so a gradient across a fixed width is evaluated
+ * once instead of once per character per frame.
+ */
+class gradientRamp {
+public:
+    gradientRamp() : stale_(true) {}
+    explicit gradientRamp(std::function<Color(double)> fn) : function_(std::move(fn)), stale_(true) {}
+
+    void setFunction(std::function<Color(double)> fn) {
+        function_ = std::move(fn);
+        stale_ = true;
+    }
+
+    bool empty() const { return !function_; }
+
+    const std::vector<Color>& sample(size_t size) {
+        if (stale_ || table_.size() != size) {
+            table_.assign(size, Color());
+            if (function_) {
+                for (size_t i = 0; i < size; ++i)
+                    table_[i] = function_(static_cast<double>(i) / static_cast<double>(size));
+            }
+            stale_ = false;
+        }
+        return table_;
+    }
+
+private:
+    std::function<Color(double)> function_;
+    std::vector<Color> table_;
+    bool stale_;
+};
+
 namespace beautyPrint{
     inline void print(std::string str){std::cerr<<str;}
     inline void print(std::string str, Color c){std::cerr<<c<<str;}
     void print(std::string str, std::function<Color(double)> ColorFunction){
         std::string str_toPrint = "";
         int len = str.length();
+        str_toPrint.reserve(len * (escape::MAX_COLOR_LENGTH + 1) + sizeof(RESET_ALL));
         for(int i = 0; i < len; i++){
             double x = (double)i / (double)len;
             Color c = ColorFunction(x);
-            str_toPrint += ESC_COLOR_CODE;
-            str_toPrint += FOREGROUND_SEQUENCE;
-            str_toPrint += std::to_string(static_cast<int>(c.R()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.G()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.B()));
-            str_toPrint += CLOSE_SEQUENCE;
+            escape::appendForeground(str_toPrint, c);
+            str_toPrint += str[i];
+        }
+        str_toPrint += RESET_ALL;
+        std::cerr << str_toPrint;
+    }
+
+    //same, with the colors looked up in a ramp sampled to the string length
+    void print(std::string str, gradientRamp& ramp){
+        std::string str_toPrint = "";
+        int len = str.length();
+        const std::vector<Color>& colors = ramp.sample(len);
+        str_toPrint.reserve(len * (escape::MAX_COLOR_LENGTH + 1) + sizeof(RESET_ALL));
+        for(int i = 0; i < len; i++){
+            escape::appendForeground(str_toPrint, colors[i]);
             str_toPrint += str[i];
         }
         str_toPrint += RESET_ALL;
@@ -158,6 +1164,7 @@ namespace beautyPrint{
     inline void print(coords pos, std::string str){cursor(pos.x, pos.y); print(str);}
     inline void print(coords pos, std::string str, Color c){cursor(pos.x, pos.y); print(str, c);}
     void print(coords pos, std::string str, std::function<Color(double)> ColorFunction){cursor(pos.x, pos.y); print(str, ColorFunction);}
+    void print(coords pos, std::string str, gradientRamp& ramp){cursor(pos.x, pos.y); print(str, ramp);}
 
     //where x is the width and y is the y
     void print(coords pos, std::string str, AvailableAlignments::EnumAlignment align){
@@ -218,6 +1225,26 @@ namespace beautyPrint{
         }
         print({start_x, pos.y}, str, ColorFunction);
     }
+
+    //where x is the width and y is the y
+    void print(coords pos, std::string str, AvailableAlignments::EnumAlignment align, gradientRamp& ramp){
+        int start_x = 0;
+        switch(align){
+            case AvailableAlignments::LEFT:
+                break;
+            case AvailableAlignments::CENTER:
+                start_x = (pos.x/2) - (str.length()/2);
+                if(start_x < 0) start_x = 0;
+                break;
+            case AvailableAlignments::RIGHT:
+                start_x = pos.x - str.length();
+                if(start_x < 0) start_x = 0;
+                break;
+            default:
+                break;
+        }
+        print({start_x, pos.y}, str, ramp);
+    }
 }
 
 
@@ -258,6 +1285,142 @@ inline Color HSLtoRGB(double h, double s, double l) {
     return result;
 }
 
+/*
+ * HSLtoRGB(h, s, l, out, count)
+ *
+ * Batch form for gradients: converts count HSL triples held in separate
+ * arrays (hue in degrees, any value). It works in float with the
+ * branch-free 12-sector formula, 8 lanes at a time with AVX or 4 with
+ * SSE2 when the compiler targets them, and a scalar loop for the rest.
+ * Results can differ from the double version above by one step.
+ */
+namespace hslKernel {
+    /* Channel n (0 red, 8 green, 4 blue): l - a * clamp(min(k - 3, 9 - k), -1, 1) */
+    inline float channel(float n, float h30, float a, float l) {
+        float k = n + h30;
+        if (k >= 12.0f) k -= 12.0f;
+        return l - a * (std::max)(-1.0f, (std::min)((std::min)(k - 3.0f, 9.0f - k), 1.0f));
+    }
+
+    inline unsigned char toByte(float v) {
+        return static_cast<unsigned char>((std::min)((std::max)(v * 255.0f + 0.5f, 0.0f), 255.5f));
+    }
+
+    inline void convertOne(float h, float s, float l, unsigned char rgb[3]) {
+        h -= 360.0f * std::floor(h / 360.0f);
+        const float h30 = h / 30.0f;
+        const float a = s * (std::min)(l, 1.0f - l);
+        rgb[0] = toByte(channel(0.0f, h30, a, l));
+        rgb[1] = toByte(channel(8.0f, h30, a, l));
+        rgb[2] = toByte(channel(4.0f, h30, a, l));
+    }
+
+#if defined(MENU_HSL_AVX)
+    static const int LANES = 8;
+
+    inline __m256 channel(__m256 n, __m256 h30, __m256 a, __m256 l) {
+        const __m256 twelve = _mm256_set1_ps(12.0f);
+        __m256 k = _mm256_add_ps(n, h30);
+        k = _mm256_sub_ps(k, _mm256_and_ps(_mm256_cmp_ps(k, twelve, _CMP_GE_OQ), twelve));
+        __m256 t = _mm256_min_ps(_mm256_sub_ps(k, _mm256_set1_ps(3.0f)), _mm256_sub_ps(_mm256_set1_ps(9.0f), k));
+        t = _mm256_max_ps(_mm256_set1_ps(-1.0f), _mm256_min_ps(t, _mm256_set1_ps(1.0f)));
+        return _mm256_sub_ps(l, _mm256_mul_ps(a, t));
+    }
+
+    inline void toBytes(__m256 v, int out[LANES]) {
+        v = _mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f));
+        v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(255.5f));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvttps_epi32(v));
+    }
+
+    /* Converts LANES triples; s and l are broadcast when their step is 0 */
+    inline void convertLanes(const float* h, const float* s, size_t s_step,
+                             const float* l, size_t l_step, int r[LANES], int g[LANES], int b[LANES]) {
+        __m256 hv = _mm256_loadu_ps(h);
+        const __m256 sv = s_step ? _mm256_loadu_ps(s) : _mm256_set1_ps(*s);
+        const __m256 lv = l_step ? _mm256_loadu_ps(l) : _mm256_set1_ps(*l);
+
+        const __m256 full = _mm256_set1_ps(360.0f);
+        hv = _mm256_sub_ps(hv, _mm256_mul_ps(full, _mm256_floor_ps(_mm256_div_ps(hv, full))));
+        const __m256 h30 = _mm256_div_ps(hv, _mm256_set1_ps(30.0f));
+        const __m256 a = _mm256_mul_ps(sv, _mm256_min_ps(lv, _mm256_sub_ps(_mm256_set1_ps(1.0f), lv)));
+
+        toBytes(channel(_mm256_setzero_ps(), h30, a, lv), r);
+        toBytes(channel(_mm256_set1_ps(8.0f), h30, a, lv), g);
+        toBytes(channel(_mm256_set1_ps(4.0f), h30, a, lv), b);
+    }
+#elif defined(MENU_HSL_SSE2)
+    static const int LANES = 4;
+
+    /* SSE2 has no floor: truncate, then step down where that rounded up */
+    inline __m128 floor(__m128 x) {
+        const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+    }
+
+    inline __m128 channel(__m128 n, __m128 h30, __m128 a, __m128 l) {
+        const __m128 twelve = _mm_set1_ps(12.0f);
+        __m128 k = _mm_add_ps(n, h30);
+        k = _mm_sub_ps(k, _mm_and_ps(_mm_cmpge_ps(k, twelve), twelve));
+        __m128 t = _mm_min_ps(_mm_sub_ps(k, _mm_set1_ps(3.0f)), _mm_sub_ps(_mm_set1_ps(9.0f), k));
+        t = _mm_max_ps(_mm_set1_ps(-1.0f), _mm_min_ps(t, _mm_set1_ps(1.0f)));
+        return _mm_sub_ps(l, _mm_mul_ps(a, t));
+    }
+
+    inline void toBytes(__m128 v, int out[LANES]) {
+        v = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.5f));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_cvttps_epi32(v));
+    }
+
+    /* Converts LANES triples; s and l are broadcast when their step is 0 */
+    inline void convertLanes(const float* h, const float* s, size_t s_step,
+                             const float* l, size_t l_step, int r[LANES], int g[LANES], int b[LANES]) {
+        __m128 hv = _mm_loadu_ps(h);
+        const __m128 sv = s_step ? _mm_loadu_ps(s) : _mm_set1_ps(*s);
+        const __m128 lv = l_step ? _mm_loadu_ps(l) : _mm_set1_ps(*l);
+
+        const __m128 full = _mm_set1_ps(360.0f);
+        hv = _mm_sub_ps(hv, _mm_mul_ps(full, floor(_mm_div_ps(hv, full))));
+        const __m128 h30 = _mm_div_ps(hv, _mm_set1_ps(30.0f));
+        const __m128 a = _mm_mul_ps(sv, _mm_min_ps(lv, _mm_sub_ps(_mm_set1_ps(1.0f), lv)));
+
+        toBytes(channel(_mm_setzero_ps(), h30, a, lv), r);
+        toBytes(channel(_mm_set1_ps(8.0f), h30, a, lv), g);
+        toBytes(channel(_mm_set1_ps(4.0f), h30, a, lv), b);
+    }
+#endif
+
+    inline void convert(const float* h, const float* s, size_t s_step, const float* l, size_t l_step,
+                        Color* out, size_t count) {
+        size_t i = 0;
+#if defined(MENU_HSL_AVX) || defined(MENU_HSL_SSE2)
+        int r[LANES], g[LANES], b[LANES];
+        for (; i + LANES <= count; i += LANES) {
+            convertLanes(h + i, s + i * s_step, s_step, l + i * l_step, l_step, r, g, b);
+            for (int k = 0; k < LANES; ++k)
+                out[i + k] = Color(static_cast<unsigned char>(r[k]),
+                                   static_cast<unsigned char>(g[k]),
+                                   static_cast<unsigned char>(b[k]));
+        }
+#endif
+        unsigned char rgb[3];
+        for (; i < count; ++i) {
+            convertOne(h[i], s[i * s_step], l[i * l_step], rgb);
+            out[i] = Color(rgb[0], rgb[1], rgb[2]);
+        }
+    }
+}
+
+inline void HSLtoRGB(const float* h, const float* s, const float* l, Color* out, size_t count) {
+    hslKernel::convert(h, s, 1, l, 1, out, count);
+}
+
+/* Same, with one saturation and lightness for every hue (the usual gradient) */
+inline void HSLtoRGB(const float* h, float s, float l, Color* out, size_t count) {
+    hslKernel::convert(h, &s, 0, &l, 0, out, count);
+}
+
 class UI_Option {
 public:
     UI_Option(const std::string& str) : text(str) {}
@@ -279,8 +1442,30 @@ public:
             if (f) f();
     }
 
+    /*
+     * work runs on cli_menu's worker threads so a slow action does not
+     * freeze the menu (a spinner shows meanwhile); done, if given, runs on
+     * the loop's thread afterwards. work must not draw or touch the menu.
+     */
+    void SubscribeAsync(void(*work)(), void(*done)() = nullptr) {
+        asyncCallBackList.push_back({ work, done });
+    }
+
+    void UnsubscribeAsync(void(*work)()) {
+        auto it = std::find_if(asyncCallBackList.begin(), asyncCallBackList.end(),
+                               [work](const asyncCallBack& a) { return a.work == work; });
+        if (it != asyncCallBackList.end())
+            asyncCallBackList.erase(it);
+    }
+
+    struct asyncCallBack {
+        void(*work)();
+        void(*done)();
+    };
+
     std::string text;
     std::vector<void(*)()> callBackList;
+    std::vector<asyncCallBack> asyncCallBackList;
     Color overwriteColor = {0,0,0};
 };
 
@@ -317,6 +1502,7 @@ private:
     UI_Option_Bar bar = bars[0];
 
     std::function<Color(double)> ColorFunction = defaultGradient;
+    gradientRamp titleRamp{ColorFunction};
 
 public:
     /* =========================
@@ -363,7 +1549,10 @@ public:
 
     void setTitleColor(Color c) { titleColor = c; }
 
-    void setTitleColor(std::function<Color(double)> new_Color_function) { ColorFunction = new_Color_function; }
+    void setTitleColor(std::function<Color(double)> new_Color_function) {
+        ColorFunction = new_Color_function;
+        titleRamp.setFunction(new_Color_function);
+    }
 
     void setTitleAlignment(AvailableAlignments::EnumAlignment a) { titleAlignment = a; }
     void setOptionsAlignment(AvailableAlignments::EnumAlignment a) { optionsAlignment = a; }
@@ -398,6 +1587,9 @@ public:
 
     Color getTitleColor(double x) {return ColorFunction ? ColorFunction(x) : titleColor;}
 
+    //color of title character i out of length, from the cached ramp
+    Color getTitleColor(int i, int length) {return ColorFunction ? titleRamp.sample(length)[i] : titleColor;}
+
     AvailableAlignments::EnumAlignment getTitleAlignment() const { return titleAlignment; }
 
     AvailableAlignments::EnumAlignment getOptionsAlignment() const { return optionsAlignment; }
@@ -442,6 +1634,17 @@ private:
 
     bool exit_var = false;
 
+    std::shared_ptr<frameSink> sink = std::make_shared<frameSink>();
+
+    eventLoop events;
+    bool redrawPending = false;
+
+    //async option callbacks; declared after events so it joins first
+    workerPool workers;
+    int busyCount = 0;
+    int busyFrame = 0;
+    int busyTimer = 0;
+
 public:
     /* =========================
        Constructors
@@ -452,26 +1655,8 @@ public:
             system("chcp 65001 >nul");
         #endif
 
-        /* Query console size */
-        #ifdef _WIN32
-            CONSOLE_SCREEN_BUFFER_INFO csbi;
-            if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) {
-                width  = csbi.srWindow.Right  - csbi.srWindow.Left + 1;
-                height = csbi.srWindow.Bottom - csbi.srWindow.Top  + 1;
-            } else {
-                width = height = -1;
-            }
-        #else
-            struct winsize w;
-            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0) {
-                width  = w.ws_col;
-                height = w.ws_row;
-            } else {
-                width = height = -1;
-            }
-        #endif
-
-        if (width < 1 || height < 1) {
+        if (!querySize(width, height)) {
+            width = height = -1;
             std::cout << "Error getting console size";
             return;
         }
@@ -483,6 +1668,31 @@ public:
         }
     }
 
+    /* Console size in cells; false when it cannot be queried */
+    static bool querySize(int& w, int& h) {
+        #ifdef _WIN32
+            CONSOLE_SCREEN_BUFFER_INFO csbi;
+            if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return false;
+            w = csbi.srWindow.Right  - csbi.srWindow.Left + 1;
+            h = csbi.srWindow.Bottom - csbi.srWindow.Top  + 1;
+        #else
+            struct winsize ws;
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0) return false;
+            w = ws.ws_col;
+            h = ws.ws_row;
+        #endif
+        return w > 0 && h > 0;
+    }
+
+    /* Pick up a new console size without init(); false when it has not changed */
+    bool resize() {
+        int w = 0, h = 0;
+        if (!querySize(w, h) || (w == width && h == height)) return false;
+        width = w;
+        height = h;
+        return true;
+    }
+
     cli_menu() {init();};
 
     cli_menu(const std::vector<subMenu>& subs)
@@ -494,6 +1704,9 @@ public:
 
     void setSubMenus(const std::vector<subMenu>& subs) { submenus = subs; }
 
+    /* Send frames to a different sink (e.g. another fd, or a capturing subclass) */
+    void setSink(std::shared_ptr<frameSink> new_sink) { if (new_sink) sink = new_sink; }
+
     void addSubMenu(const subMenu& sm) { submenus.push_back(sm); }
 
     void addSubMenus(const std::vector<subMenu>& new_subs) {
@@ -602,37 +1815,111 @@ public:
     }
 
     void clearConsole(){
-        //Use cerr to bypass buffering
-        std::cerr << RESET_ALL << RESET_BLINKING << RESET_BOLD << ERASE_CONSOLE;
+        sink->append(RESET_ALL RESET_BLINKING RESET_BOLD ERASE_CONSOLE);
+        sink->flush();
     }
 
+    /*
+     * Keys, timers and resizes arrive through the event loop; the menu is
+     * redrawn once they are handled, and only if one of them changed it.
+     */
     void startLoop(){
         exit_var = submenus.empty();
-        while (!exit_var) {
-            DrawMenu();
-            int c = 0;
-            switch ((c = getch())) {
-                case KEY_UP:
-                    submenus[selectedSubMenu].decrementOption();
-                    break;
-                case KEY_DOWN:
-                    submenus[selectedSubMenu].incrementOption();
-                    break;
-                case 13:
-                    submenus[selectedSubMenu].CallSelectedOption();
-                    break;
-                default:
-                    std::cout << std::endl << "null" << std::endl;
-                    break;
+        redrawPending = true;
+        events.onKey = [this](int c) { handleKey(c); };
+        events.onResize = [this]() {
+            if (resize()) redrawPending = true;
+        };
+        events.onIdle = [this]() {
+            if (exit_var) {
+                events.stop();
+                return;
+            }
+            if (redrawPending) {
+                redrawPending = false;
+                DrawMenu();
+            }
+        };
+        if (!exit_var) events.run();
+    }
+
+    void handleKey(int c){
+        if (exit_var) return;
+        switch (c) {
+            case InputKeys::Up:
+                submenus[selectedSubMenu].decrementOption();
+                redrawPending = true;
+                break;
+            case InputKeys::Down:
+                submenus[selectedSubMenu].incrementOption();
+                redrawPending = true;
+                break;
+            case 13: {
+                const std::vector<UI_Option>& options = submenus[selectedSubMenu].getOptions();
+                if (options.empty()) break;
+                //a copy: the callbacks may switch or change the submenus
+                const UI_Option option = options[submenus[selectedSubMenu].getSelectedIndex()];
+                if (!option.callBackList.empty())
+                    events.cooked([&option]() { option.Call(); });
+                startAsync(option);
+                redrawPending = true;
+                break;
             }
+            default:
+                break;
         }
     }
 
+    //async callbacks go to the workers and report back through the event loop
+    void startAsync(const UI_Option& option){
+        for (const UI_Option::asyncCallBack& callback : option.asyncCallBackList) {
+            if (!callback.work) continue;
+            setBusy(+1);
+            workers.submit([this, callback]() {
+                callback.work();
+                events.post([this, callback]() {
+                    if (callback.done) events.cooked(callback.done);
+                    setBusy(-1);
+                });
+            });
+        }
+    }
 
+    //number of async callbacks still running
+    int busy() const { return busyCount; }
+
+    //threads for async callbacks (2 by default); set before the first one starts
+    void setWorkerThreads(unsigned count) { workers = workerPool(count); }
+
+    void setBusy(int delta){
+        const bool wasBusy = busyCount > 0;
+        busyCount = (std::max)(0, busyCount + delta);
+        if (!wasBusy && busyCount > 0) {
+            busyTimer = addTimer(100, [this]() {
+                ++busyFrame;
+                return true;
+            });
+        } else if (wasBusy && busyCount == 0) {
+            events.removeTimer(busyTimer);
+        }
+        redrawPending = true;
+    }
 
+    void requestRedraw() { redrawPending = true; }
+
+    /* Run tick every interval_ms from the loop; redraw after it when it returns true */
+    int addTimer(int interval_ms, std::function<bool()> tick) {
+        return events.addTimer(interval_ms, [this, tick]() {
+            if (tick()) redrawPending = true;
+        });
+    }
+
+    void removeTimer(int id) { events.removeTimer(id); }
 
     void DrawMenu(){
-        clearConsole();
+        //The whole frame is collected and sent with one write
+        std::string& frame = sink->frame();
+        frame += RESET_ALL RESET_BLINKING RESET_BOLD ERASE_CONSOLE;
 
         subMenu &_menu = submenus[selectedSubMenu];
         int top_offset = 2;
@@ -644,18 +1931,9 @@ public:
         std::string title; title.reserve(title_abs_length);
         for(int i = 0; i < title_length; i++){
             Color char_Color = _menu.getTitleColor();
-            if(char_Color == Color{0, 0, 0}){
-                double x = (double)i / double(title_length);
-                char_Color = _menu.getTitleColor(x);
-            }
-            title += ESC_COLOR_CODE;
-            title += FOREGROUND_SEQUENCE;
-            title += std::to_string(static_cast<int>(char_Color.R()));
-            title += SEQUENCE_ARG_SEPARATOR;
-            title += std::to_string(static_cast<int>(char_Color.G()));
-            title += SEQUENCE_ARG_SEPARATOR;
-            title += std::to_string(static_cast<int>(char_Color.B()));
-            title += CLOSE_SEQUENCE;
+            if(char_Color == Color{0, 0, 0})
+                char_Color = _menu.getTitleColor(i, title_length);
+            escape::appendForeground(title, char_Color);
             title += char_title[i];
         }
         title += RESET_ALL;
@@ -675,8 +1953,8 @@ public:
         default:
             break;
         }
-        cursor(start_x, top_offset);
-        std::cerr << title;
+        escape::appendCursor(frame, start_x, top_offset);
+        frame += title;
         top_offset++;
 
         //print options
@@ -698,14 +1976,7 @@ public:
                 bar_left = bar.selected_before;
             }
 
-            str_toPrint += ESC_COLOR_CODE;
-            str_toPrint += FOREGROUND_SEQUENCE;
-            str_toPrint += std::to_string(static_cast<int>(c.R()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.G()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.B()));
-            str_toPrint += CLOSE_SEQUENCE;
+            escape::appendForeground(str_toPrint, c);
             str_toPrint += bar_left;
             option_length += bar_left.length();
             //text Color
@@ -718,14 +1989,7 @@ public:
             }
 
             //text
-            str_toPrint += ESC_COLOR_CODE;
-            str_toPrint += FOREGROUND_SEQUENCE;
-            str_toPrint += std::to_string(static_cast<int>(c.R()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.G()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.B()));
-            str_toPrint += CLOSE_SEQUENCE;
+            escape::appendForeground(str_toPrint, c);
             str_toPrint += opt.text;
             option_length += opt.text.length();
             //bar Color
@@ -739,14 +2003,7 @@ public:
                 bar_right = bar.selected_after;
             }
 
-            str_toPrint += ESC_COLOR_CODE;
-            str_toPrint += FOREGROUND_SEQUENCE;
-            str_toPrint += std::to_string(static_cast<int>(c.R()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.G()));
-            str_toPrint += SEQUENCE_ARG_SEPARATOR;
-            str_toPrint += std::to_string(static_cast<int>(c.B()));
-            str_toPrint += CLOSE_SEQUENCE;
+            escape::appendForeground(str_toPrint, c);
             str_toPrint += bar_right;
 
             option_length += bar_right.length();
@@ -766,11 +2023,19 @@ public:
             default:
                 break;
             }
-            cursor(start_x, top_offset);
-            std::cerr << str_toPrint;
+            escape::appendCursor(frame, start_x, top_offset);
+            frame += str_toPrint;
             top_offset++;
         }
-        cursor(0, height-1);
+        //busy indicator while async callbacks run
+        if (busyCount > 0 && width > 1) {
+            static const char spinner[] = { '|', '/', '-', '\\' };
+            escape::appendCursor(frame, width-2, height-1);
+            escape::appendForeground(frame, Color(255, 255, 255));
+            frame += spinner[busyFrame % 4];
+        }
+        escape::appendCursor(frame, 0, height-1);
+        sink->flush();
     }
 
 };
@@ -26,7 +26,7 @@ void f_settings()
     }
     cursor(0, global_menu->getHeight() - 1);
     cout << "press enter to get back";
-    _getch();
+    readKey();
 }
 
 void f_exit()
@@ -47,7 +47,7 @@ Color rainbowColor(double x)
 int main()
 {
     cout << "Resize the console and set your desired font size (ctrl + + or ctrl + scroll wheel)\nThe interactive menu will get resize acordingly.";
-    _getch();
+    readKey();
     cli_menu menu({
         subMenu("Main menu example", {
                     UI_Option("Start", f_start),
@@ -29,7 +29,7 @@ Color blueToPurple(double x)
 int main()
 {
     cout << "Resize the console and set your desired font size (ctrl + + or ctrl + scroll wheel)\nThe interactive menu will get resize acordingly.";
-    _getch();
+    readKey();
     cli_menu menu;
     menu.clearConsole();
 